@@ -11,6 +11,17 @@ enum
 	SDK_EXAMPLE_RULEDMESH_PARAM_SECOND = 1005,
 		SDK_EXAMPLE_RULEDMESH_PARAM_NATURAL = 0,
 		SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM = 1,
+	SDK_EXAMPLE_RULEDMESH_ADAPTIVE           = 1006,
+	SDK_EXAMPLE_RULEDMESH_ADAPTIVE_TOLERANCE = 1007,
+	SDK_EXAMPLE_RULEDMESH_MODE               = 1008,
+		SDK_EXAMPLE_RULEDMESH_MODE_RULED       = 0,
+		SDK_EXAMPLE_RULEDMESH_MODE_LOFT_LINEAR = 1,
+		SDK_EXAMPLE_RULEDMESH_MODE_LOFT_SMOOTH = 2,
+	SDK_EXAMPLE_RULEDMESH_GENERATE_UVW       = 1009,
+	SDK_EXAMPLE_RULEDMESH_GENERATE_NORMALS   = 1010,
+	SDK_EXAMPLE_RULEDMESH_RENDER_LOD         = 1011,
+	SDK_EXAMPLE_RULEDMESH_RENDER_S_STEPS     = 1012,
+	SDK_EXAMPLE_RULEDMESH_RENDER_T_STEPS     = 1013,
 };
 
 #endif // ORULEDMESH_H__
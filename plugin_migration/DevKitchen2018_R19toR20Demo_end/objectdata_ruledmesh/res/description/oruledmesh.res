@@ -5,8 +5,20 @@ CONTAINER oruledmesh
 
 	GROUP ID_OBJECTPROPERTIES
 	{
+		LONG SDK_EXAMPLE_RULEDMESH_MODE
+		{
+			CYCLE
+			{
+				SDK_EXAMPLE_RULEDMESH_MODE_RULED;
+				SDK_EXAMPLE_RULEDMESH_MODE_LOFT_LINEAR;
+				SDK_EXAMPLE_RULEDMESH_MODE_LOFT_SMOOTH;
+			}
+		}
 		LONG SDK_EXAMPLE_RULEDMESH_S_STEPS      { MIN 1; }
 		LONG SDK_EXAMPLE_RULEDMESH_T_STEPS      { MIN 1; }
+		BOOL SDK_EXAMPLE_RULEDMESH_RENDER_LOD   {}
+		LONG SDK_EXAMPLE_RULEDMESH_RENDER_S_STEPS { MIN 1; }
+		LONG SDK_EXAMPLE_RULEDMESH_RENDER_T_STEPS { MIN 1; }
 		BOOL SDK_EXAMPLE_RULEDMESH_FLIP_FIRST   {}
 		BOOL SDK_EXAMPLE_RULEDMESH_FLIP_SECOND  {}
 		LONG SDK_EXAMPLE_RULEDMESH_PARAM_FIRST  
@@ -25,5 +37,11 @@ CONTAINER oruledmesh
 				SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM;
 			}
 		}
+		SEPARATOR { LINE; }
+		BOOL SDK_EXAMPLE_RULEDMESH_ADAPTIVE            {}
+		REAL SDK_EXAMPLE_RULEDMESH_ADAPTIVE_TOLERANCE  { UNIT METER; MIN 0.001; STEP 0.1; }
+		SEPARATOR { LINE; }
+		BOOL SDK_EXAMPLE_RULEDMESH_GENERATE_UVW        {}
+		BOOL SDK_EXAMPLE_RULEDMESH_GENERATE_NORMALS    {}
 	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "c4d_resource.h"
 
 #include "objectdata_ruledmesh.h"
+#include "ruledmesh_benchmark.h"
 
 ::Bool PluginStart()
 {
@@ -28,6 +29,32 @@ void PluginEnd()
 
 			return true;
 		}
+
+#ifdef RULEDMESH_BENCHMARK
+		case C4DPL_COMMANDLINEARGS:
+		{
+			// run the RuledMesh benchmark when requested and consume its arguments
+			C4DPL_CommandLineArgs* args = static_cast<C4DPL_CommandLineArgs*>(data);
+			if (!args)
+				return false;
+
+			for (Int32 i = 0; i < args->argc - 1; ++i)
+			{
+				if (!args->argv[i] || strcmp(args->argv[i], RULEDMESH_BENCHMARK_ARG) != 0 || !args->argv[i + 1])
+					continue;
+
+				const Filename csvFile(String(args->argv[i + 1]));
+				args->argv[i] = nullptr;
+				args->argv[i + 1] = nullptr;
+
+				iferr (RunRuledMeshBenchmark(csvFile))
+					DiagnosticOutput("RuledMesh benchmark failed: @", err);
+				break;
+			}
+
+			return true;
+		}
+#endif
 	}
 
 	return true;
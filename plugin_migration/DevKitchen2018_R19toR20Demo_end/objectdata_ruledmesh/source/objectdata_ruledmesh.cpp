@@ -5,148 +5,275 @@
 #include "c4d_thread.h"
 #include "c4d_symbols.h"
 
+#include "maxon/parallelfor.h"
+
 #include "objectdata_ruledmesh.h"
+#include "ruledmesh_benchmark.h"
 
 // Local resources
 #include "oruledmesh.h"
 
 
 //------------------------------------------------------------------------------------------------
-/// Global helper function to populate PolygonObject vertices array and polygon indexes array
-/// with the data contained in a 2-dim array of vector listing the vertices space position.
-/// @brief Global helper function to populate PolygonObject with data from 2-dim array of positions.
+/// Global helper function to write the quadrangle indexes of a row of cells.
+/// @brief Global helper function to write the polygon indexes of a row of cells.
+/// @param[out] rowPolysW					The pointer to the polygon indexes array of the current row. @callerOwnsPointed{polygon array}.
+/// @param[in] rowIdx							The index of the first vertex of the current row.
+/// @param[in] nextRowIdx					The index of the first vertex of the next row.
+/// @param[in] polysAlongT				The number of cells along the T-direction.
+//------------------------------------------------------------------------------------------------
+static void FillPolygonsRow(CPolygon* rowPolysW, const Int32 rowIdx, const Int32 nextRowIdx, const Int32 polysAlongT)
+{
+	for (Int32 t = 0; t < polysAlongT; ++t)
+		rowPolysW[t] = CPolygon(rowIdx + t, nextRowIdx + t, nextRowIdx + t + 1, rowIdx + t + 1);
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to write the UVW coordinates and the vertex normals of a row of cells.
+/// The U coordinate follows the T-direction whilst the V coordinate is the S-parameter of the row.
+/// @brief Global helper function to write the UVW coordinates and the normals of a row of cells.
+/// @param[out] uvwW							The handle to the UVW tag data, nullptr to skip the UVW coordinates.
+/// @param[out] normalW						The handle to the Normal tag data, nullptr to skip the normals.
+/// @param[in] rowNormalsR				The pointer to the vertex normals of the current row. @callerOwnsPointed{normals array}.
+/// @param[in] nextRowNormalsR		The pointer to the vertex normals of the next row. @callerOwnsPointed{normals array}.
+/// @param[in] firstPolyIdx				The index of the first polygon of the current row.
+/// @param[in] v									The S-parameter of the current row.
+/// @param[in] nextV							The S-parameter of the next row.
+/// @param[in] polysAlongT				The number of cells along the T-direction.
+//------------------------------------------------------------------------------------------------
+static void FillAttributesRow(UVWHandle uvwW, NormalHandle normalW, const Vector* rowNormalsR, const Vector* nextRowNormalsR, const Int32 firstPolyIdx, const Float v, const Float nextV, const Int32 polysAlongT)
+{
+	const Float tStep = 1.0 / Float(polysAlongT);
+
+	for (Int32 t = 0; t < polysAlongT; ++t)
+	{
+		const Int32 polyIdx = firstPolyIdx + t;
+
+		if (uvwW)
+		{
+			const Vector a(Float(t) * tStep, v, 0.0);
+			const Vector b(Float(t) * tStep, nextV, 0.0);
+			const Vector c(Float(t + 1) * tStep, nextV, 0.0);
+			const Vector d(Float(t + 1) * tStep, v, 0.0);
+			UVWTag::Set(uvwW, polyIdx, UVWStruct(a, b, c, d));
+		}
+
+		if (normalW && rowNormalsR && nextRowNormalsR)
+			NormalTag::Set(normalW, polyIdx, NormalStruct(rowNormalsR[t], nextRowNormalsR[t], nextRowNormalsR[t + 1], rowNormalsR[t + 1]));
+	}
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to populate a band of rows of the PolygonObject polygon indexes array. The
+/// vertices are expected to be stored row by row (S-major) in the PolygonObject point array and the
+/// mesh is made of quadrangles. The UVW and Normal tags, if given, are filled in the same pass.
+/// @brief Global helper function to populate PolygonObject polygon indexes.
 /// @param[out] polyObj						The reference to the PolygonObject instance.
 /// @param[in] verticesAlongS			The reference to the number of vertices along the S-direction.
 /// @param[in] verticesAlongT			The reference to the number of vertices along the T-direction.
-/// @param[in] hh									The pointer to the HierarchyHelp isntance. @callerOwnsPointed{hierarchy helper}.
-/// @param[in] verticesBA					The reference to the 2-dim BaseArray instance containing the vertices's position.
+/// @param[in] rowStart						The reference to the index of the first row of cells to fill.
+/// @param[in] rowEnd							The reference to the index past the last row of cells to fill.
 /// @param[in] closedS						The reference to the boolean closure status along S-direction.
-/// @param[in] closedT						The reference to the boolean closure status along T-direction.
+/// @param[in] sParams						The pointer to the array of S-parameters of the vertices rows, required by the UVW tag. @callerOwnsPointed{parameters array}.
+/// @param[out] uvwTag						The pointer to the UVW tag to fill, nullptr to skip it. @callerOwnsPointed{tag}.
+/// @param[out] normalTag					The pointer to the Normal tag to fill, nullptr to skip it. @callerOwnsPointed{tag}.
+/// @param[in] bandNormalsR				The pointer to the vertex normals of the rows from rowStart to rowEnd (included), required by the Normal tag. @callerOwnsPointed{normals array}.
 /// @return												maxon::OK if operation completes successfully, maxon::Result otherwise.
 //------------------------------------------------------------------------------------------------
-static maxon::Result<void> FillPolygonObjectData(PolygonObject &polyObj, const Int32 &verticesAlongS, const Int32& verticesAlongT, HierarchyHelp* hh, const maxon::BaseArray<maxon::BaseArray<Vector>> &verticesBA, const Bool& closedS = false, const Bool& closedT = false);
-static maxon::Result<void> FillPolygonObjectData(PolygonObject &polyObj, const Int32 &verticesAlongS, const Int32& verticesAlongT, HierarchyHelp* hh, const maxon::BaseArray<maxon::BaseArray<Vector>> &verticesBA, const Bool& closedS /*= false*/, const Bool& closedT /*= false*/)
+static maxon::Result<void> FillPolygonObjectData(PolygonObject &polyObj, const Int32 &verticesAlongS, const Int32& verticesAlongT, const Int32 &rowStart, const Int32 &rowEnd, const Bool& closedS = false, const maxon::BaseArray<Float>* sParams = nullptr, UVWTag* uvwTag = nullptr, NormalTag* normalTag = nullptr, const Vector* bandNormalsR = nullptr);
+static maxon::Result<void> FillPolygonObjectData(PolygonObject &polyObj, const Int32 &verticesAlongS, const Int32& verticesAlongT, const Int32 &rowStart, const Int32 &rowEnd, const Bool& closedS /*= false*/, const maxon::BaseArray<Float>* sParams /*= nullptr*/, UVWTag* uvwTag /*= nullptr*/, NormalTag* normalTag /*= nullptr*/, const Vector* bandNormalsR /*= nullptr*/)
 {
-	Vector* verticesArrayW = polyObj.GetPointW();
-	if (!verticesArrayW)
-		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to access writeble point array"_s);
-
 	CPolygon* polysIdxArrayW = polyObj.GetPolygonW();
 	if (!polysIdxArrayW)
 		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to access polygon indexes array"_s);
 
-	Int32 vtxIdx, s, t;
+	// Retrieve the tags data: the UVW coordinates need the rows parameters and the normals need the
+	// vertex normals to be written.
+	UVWHandle uvwW = (uvwTag && sParams) ? uvwTag->GetDataAddressW() : nullptr;
+	NormalHandle normalW = (normalTag && bandNormalsR) ? normalTag->GetDataAddressW() : nullptr;
+	const Bool attributes = uvwW || normalW;
+
 	const Int32 polysAlongS = verticesAlongS - 1;
 	const Int32 polysAlongT = verticesAlongT - 1;
 
-	Int32 vertsAlongS = verticesAlongS;
-	if (closedS)
-		vertsAlongS--;
+	for (Int32 s = rowStart; s < maxon::Min(rowEnd, polysAlongS); ++s)
+	{
+		// The last row of a closed mesh connects back to the first vertices row.
+		const Int32 rowIdx = s * verticesAlongT;
+		const Int32 nextRowIdx = (closedS && s == polysAlongS - 1) ? 0 : rowIdx + verticesAlongT;
+		FillPolygonsRow(polysIdxArrayW + s * polysAlongT, rowIdx, nextRowIdx, polysAlongT);
 
-	Int32 vertsAlongT = verticesAlongT;
-	if (closedT)
-		vertsAlongT--;
+		if (!attributes)
+			continue;
 
-	for (s = 0; s < (vertsAlongS); ++s)
-	{
-		for (t = 0; t < (vertsAlongT); ++t)
-		{
-			if (hh)
-			{
-				// Check from time to time (every 64 segments) if a user break has been requested.
-				BaseThread* btPtr = hh->GetThread();
-				if (btPtr && !(t & 63) && btPtr->TestBreak())
-					return maxon::OK;
-			}
+		// The last row of a closed mesh reaches the end of the S-range.
+		const Float v = sParams ? (*sParams)[s] : 0.0;
+		const Float nextV = (sParams && s + 1 < sParams->GetCount()) ? (*sParams)[s + 1] : 1.0;
 
-			vtxIdx = s * vertsAlongT + t;
-			// Fill the vertices data.
-			verticesArrayW[vtxIdx] = verticesBA[s][t];
+		// The band normals start at the first row of the band and include the row following it.
+		const Vector* rowNormalsR = bandNormalsR ? bandNormalsR + (s - rowStart) * verticesAlongT : nullptr;
+		const Vector* nextRowNormalsR = rowNormalsR ? rowNormalsR + verticesAlongT : nullptr;
 
-			// Fill the polygons indices.
-			if (s < polysAlongS && t < polysAlongT)
-			{
-				// Define the general polygon index.
-				Int32 polyIdx = s * polysAlongT + t;
-
-				Int32 s_pad = 0;
-				Int32 t_pad = 0;
-				if (closedS && s == polysAlongS - 1)
-					s_pad = vertsAlongS;
-				if (closedT && t == polysAlongT - 1)
-					t_pad = vertsAlongT;
-
-				// Check the type of generated face (triangles or quadrangles).
-				if (polyObj.GetPolygonCount() != (polysAlongS * polysAlongT))
-				{
-					Int32 polyIdxA = 2 * polyIdx;
-					Int32 polyIdxB = 2 * polyIdx + 1;
-
-					// Fill polygon (triangle A) by using indexes for the vertexes generated above.
-					polysIdxArrayW[polyIdxA] = CPolygon(
-						t + s * vertsAlongT,
-						t + (s + 1 - s_pad) * vertsAlongT,
-						t + (s + 1 - s_pad) * vertsAlongT + 1 - t_pad
-						);
-
-					//	Fill polygon (triangle B) by using indexes for the vertexes generated above.
-					polysIdxArrayW[polyIdxB] = CPolygon(
-						t + s * vertsAlongT,
-						t + (s + 1 - s_pad) * vertsAlongT + 1 - t_pad,
-						t + s * vertsAlongT + 1 - t_pad
-						);
-				}
-				else
-				{
-					//	Fill polygon [quad] by using indexes for the vertexes generated above.
-					polysIdxArrayW[polyIdx] = CPolygon(
-						t + s * vertsAlongT,
-						t + (s + 1 - s_pad) * vertsAlongT,
-						t + (s + 1 - s_pad) * vertsAlongT + 1 - t_pad,
-						t + s * vertsAlongT + 1 - t_pad
-						);
-				}
-			}
-		}
+		FillAttributesRow(uvwW, normalW, rowNormalsR, nextRowNormalsR, s * polysAlongT, v, nextV, polysAlongT);
 	}
 	return maxon::OK;
 }
 
 //------------------------------------------------------------------------------------------------
-/// Global helper function to resize the BaseArray of BaseArray of vector for storing points pos.
-/// @brief Global helper function to create, init and return a 2-dim BaseArray of vector.
-/// @param[in] verticesBA					The 2-dim BaseArray storing the vertices position.
-/// @param[in] sizeA							The size of the first dimension.
-/// @param[in] sizeB							The size of the second dimension.
-/// @param[in] closedA						The reference to the boolean closure status along S-direction.
-/// @param[in] closedB						The reference to the boolean closure status along T-direction.
-/// @return												True if resize successfully occurs, false otherwise.
+/// Global helper function to evaluate the global position of a curve at the given parameter taking
+/// into account the curve direction and parametrization.
+/// @brief Global helper function to evaluate a point on a curve.
+/// @param[in] crv								The pointer to the SplineObject instance. @callerOwnsPointed{spline object}.
+/// @param[in] lengthHelper				The pointer to the SplineLengthData instance, used for uniform parametrization. @callerOwnsPointed{spline length data}.
+/// @param[in] localMtx						The reference to the local transformation of the curve.
+/// @param[in] sParam							The parameter along the S-direction in the [0, 1] range.
+/// @param[in] flip								The reference to the invert direction flag on the curve.
+/// @param[in] param							The reference to the parametrization type on the curve.
+/// @return												The global position of the point on the curve.
 //------------------------------------------------------------------------------------------------
-static maxon::Result<void> ResizeVerticesBaseArray(maxon::BaseArray<maxon::BaseArray<Vector>> &verticesBA, const Int32 &sizeA, const Int32 &sizeB, const Bool& closedA = false, const Bool& closedB = false);
-static maxon::Result<void> ResizeVerticesBaseArray(maxon::BaseArray<maxon::BaseArray<Vector>> &verticesBA, const Int32 &sizeA, const Int32 &sizeB, const Bool& closedA /*= false*/, const Bool& closedB /*= false*/)
+static Vector GetPointOnCurve(SplineObject* crv, SplineLengthData* lengthHelper, const Matrix& localMtx, Float sParam, const Bool& flip, const Int32& param)
 {
-	iferr_scope;
-	
-	Int32 sizeA_ = sizeA;
-	if (closedA)
-		sizeA_--;
-	Int32 sizeB_ = sizeB;
-	if (closedB)
-		sizeB_--;
+	Float abscissa = sParam;
+
+	// Check if the curve has been flipped and accordingly change the param value.
+	if (flip)
+		abscissa = 1.0 - abscissa;
+
+	// Check the parametrization of the curve and modify the abscissa accordingly
+	if (param == SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM && lengthHelper)
+		abscissa = lengthHelper->UniformToNatural(abscissa);
+
+	// Retrieve the position of the point on the spline object and transform it in global coordinates.
+	return localMtx * crv->GetSplinePoint(abscissa);
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to compute the bounding box of the vertices of a PolygonObject. The
+/// polygons are planar between their vertices, so the box contains the whole generated surface.
+/// @brief Global helper function to compute the bounding box of the vertices of a PolygonObject.
+/// @param[in] polyObj						The reference to the PolygonObject instance.
+/// @param[out] bboxMin						The reference to the minimum corner of the bounding box.
+/// @param[out] bboxMax						The reference to the maximum corner of the bounding box.
+/// @return												True if the PolygonObject has vertices, false otherwise.
+//------------------------------------------------------------------------------------------------
+static Bool ComputeVerticesBoundingBox(const PolygonObject& polyObj, Vector& bboxMin, Vector& bboxMax)
+{
+	const Vector* pointsR = polyObj.GetPointR();
+	const Int32 pointsCount = polyObj.GetPointCount();
 
-	verticesBA.Resize(sizeA_) iferr_return;
+	bboxMin = Vector(maxon::MAXVALUE_FLOAT);
+	bboxMax = Vector(maxon::MINVALUE_FLOAT);
 
-	for (Int32 i = 0; i < verticesBA.GetCount(); i++)
+	if (!pointsR)
+		return false;
+
+	for (Int32 i = 0; i < pointsCount; ++i)
 	{
-		verticesBA[i].Resize(sizeB_) iferr_return;
+		bboxMin = Min(bboxMin, pointsR[i]);
+		bboxMax = Max(bboxMax, pointsR[i]);
 	}
 
-	return maxon::OK;
+	return pointsCount > 0;
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to visit an input object and all the objects below it depth-first.
+/// @brief Global helper function to visit an object hierarchy.
+/// @param[in] root								The pointer to the first visited object. @callerOwnsPointed{object}.
+/// @param[in] fn									The function called as fn(BaseObject* obj) for every visited object.
+//------------------------------------------------------------------------------------------------
+template <typename FN> static void ForEachObjectInHierarchy(BaseObject* root, FN&& fn)
+{
+	fn(root);
+
+	BaseObject* obj = root->GetDown();
+	while (obj && obj != root)
+	{
+		fn(obj);
+
+		if (obj->GetDown())
+		{
+			obj = obj->GetDown();
+			continue;
+		}
+		while (obj != root && !obj->GetNext())
+			obj = obj->GetUp();
+		if (obj != root)
+			obj = obj->GetNext();
+	}
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to combine the dirty counts of an input curve and of the objects below it,
+/// e.g. deformers, into a checksum changing whenever the curve delivered by the hierarchy changes.
+/// The cache dirty count of the curve also covers the objects linked by a spline generator.
+/// @brief Global helper function to compute the dirty checksum of an input curve hierarchy.
+/// @param[in] leaf								The pointer to the input object. @callerOwnsPointed{object}.
+/// @return												The dirty checksum of the hierarchy.
+//------------------------------------------------------------------------------------------------
+static UInt64 GetHierarchyDirtyChecksum(BaseObject* leaf)
+{
+	UInt64 checksum = 14695981039346656037ULL;
+	ForEachObjectInHierarchy(leaf, [&checksum, leaf](BaseObject* obj)
+	{
+		// The own placement of the curve doesn't change its arc-length, the one of its children does.
+		const DIRTYFLAGS flags = obj == leaf ? DIRTYFLAGS::DATA | DIRTYFLAGS::CACHE : DIRTYFLAGS::DATA | DIRTYFLAGS::CACHE | DIRTYFLAGS::MATRIX;
+		checksum = (checksum ^ UInt64(obj->GetDirty(flags))) * 1099511628211ULL;
+	});
+
+	return checksum;
+}
+
+/// Number of vertices (approximately) generated in a band of rows before moving to the next one.
+static const Int32 RULEDMESH_BAND_VERTICES = 65536;
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to start measuring a phase of the generation. The phases are only
+/// measured when RULEDMESH_BENCHMARK is defined, see ruledmesh_benchmark.h.
+/// @brief Global helper function to start measuring a phase.
+/// @param[in] stats							The pointer to the statistics of the generator, nullptr if not collected.
+/// @return												The current time if the statistics are collected, zero otherwise.
+//------------------------------------------------------------------------------------------------
+static inline maxon::TimeValue StartPhase(const RuledMeshPhaseStats* stats)
+{
+#ifdef RULEDMESH_BENCHMARK
+	if (stats)
+		return maxon::TimeValue::GetTime();
+#endif
+	return maxon::TimeValue();
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to add the time elapsed since the phase start and the estimated size of
+/// the allocated buffers to the statistics of a phase, if collected.
+/// @brief Global helper function to stop measuring a phase.
+/// @param[in] stats							The pointer to the statistics of the generator, nullptr if not collected.
+/// @param[in] phase							The measured phase.
+/// @param[in] start							The time returned by StartPhase().
+/// @param[in] estimatedBytes		The size of the buffers allocated in the phase, computed from the element counts.
+//------------------------------------------------------------------------------------------------
+static inline void EndPhase(RuledMeshPhaseStats* stats, const RULEDMESH_PHASE phase, const maxon::TimeValue& start, const Int64 estimatedBytes = 0)
+{
+#ifdef RULEDMESH_BENCHMARK
+	if (!stats)
+		return;
+
+	stats->time[phase] += maxon::TimeValue::GetTime() - start;
+	stats->estimatedBytes[phase] += estimatedBytes;
+#endif
 }
 
+/// Contexts the RuledMesh results are built for when separate render steps are used.
+enum RULEDMESH_LOD
+{
+	RULEDMESH_LOD_EDITOR = 0,
+	RULEDMESH_LOD_RENDER
+};
+
 //------------------------------------------------------------------------------------------------
 /// ObjectData implementation responsible for generating a ruled mesh using two curves as input 
 /// objects and connecting via linear interpolation (https://en.wikipedia.org/wiki/Ruled_surface). 
+/// In loft mode all the children curves are connected, either piecewise linearly or smoothly.
 /// Mesh creation is controlled by specifying S/T curves segmentations and curves parametrization.
 //------------------------------------------------------------------------------------------------
 class RuledMesh : public ObjectData
@@ -156,35 +283,96 @@ class RuledMesh : public ObjectData
 public:
 	static NodeData* Alloc(){  return NewObj(RuledMesh) iferr_ignore("RuledMesh plugin not instanced"); }
 	virtual Bool Init(GeListNode *node);
+	virtual void Free(GeListNode *node);
 	virtual void GetDimension(BaseObject *op, Vector *mp, Vector *rad);
 	virtual BaseObject* GetVirtualObjects(BaseObject *op, HierarchyHelp *hh);
 	virtual Bool Message(GeListNode* node, Int32 type, void* data);
+	virtual Bool GetDEnabling(GeListNode* node, const DescID& id, const GeData& t_data, DESCFLAGS_ENABLE flags, const BaseContainer* itemdesc);
 
 private:
 	//------------------------------------------------------------------------------------------------
-	/// Private method to check the dirty status and clone (eventually) the input objects.
-	/// @brief Method to check the dirty status and clone (eventually) the input objects.
+	/// Private method to check the dirty status of the generator and of the input objects without
+	/// cloning them. The input objects are checked together with their whole hierarchy, e.g. a
+	/// deformer under a curve. If nothing has changed the input objects are touched to keep them hidden.
+	/// @brief Method to check the dirty status of the generator and of the input objects.
+	/// @param[in] op							The pointer to the BaseObject instance. @callerOwnsPointed{hierarchy helper}.
+	/// @param[in] hh							The pointer to the HierarchyHelp isntance. @callerOwnsPointed{object}.
+	/// @param[in] leaves				The reference to the array of input objects. @callerOwnsPointed{objects}.
+	/// @return										True if the generator has to be rebuilt, false otherwise.
+	//------------------------------------------------------------------------------------------------
+	Bool IsDirty(BaseObject* op, HierarchyHelp* hh, const maxon::BaseArray<BaseObject*> &leaves);
+
+	//------------------------------------------------------------------------------------------------
+	/// Private method to clone the input objects used by the generator. Only these objects are cloned
+	/// and touched, the children not used as curves are left visible.
+	/// @brief Method to clone the input objects.
 	/// @param[in] op							The pointer to the BaseObject instance. @callerOwnsPointed{hierarchy helper}.
 	/// @param[in] hh							The pointer to the HierarchyHelp isntance. @callerOwnsPointed{object}.
-	/// @param[in] dirtyFlag			The reference to the Bool dirty flag.
-	/// @param[in] firstChild			The pointer to the first input object to start the clone from. @callerOwnsPointed{object}.
+	/// @param[in] leaves				The reference to the array of input objects. @callerOwnsPointed{objects}.
 	/// @return										True if successful, false otherwise.
 	//------------------------------------------------------------------------------------------------
-	maxon::Result<void> GetFirstAndSecondClonedCurves(BaseObject* op, HierarchyHelp* hh, Bool &dirtyFlag, BaseObject* firstChild);
+	maxon::Result<void> GetClonedCurves(BaseObject* op, HierarchyHelp* hh, const maxon::BaseArray<BaseObject*> &leaves);
 	
 	//------------------------------------------------------------------------------------------------
-	/// Private method to populate the 2-dim BAseArray responsible for storing the vertices position.
-	/// @brief Method to populate the 2-dim BAseArray responsible for storing the vertices position.
-	/// @param[in] verticesData		The reference to the 2-dim BaseArray instance.
-	/// @param[in] stepsS					The reference to the number of segments on S.
-	/// @param[in] stepsT					The reference to the number of segments on T.
-	/// @param[in] firstFlip			The reference to the invert direction flag on the first curve.
-	/// @param[in] secondFlip			The reference to the invert direction flag on the second curve.
+	/// Private method to write the vertices position of a band of rows (S-major) into a flat vertices
+	/// array. Along T every row spans all the input curves, using stepsT segments between two of them.
+	/// If requested the vertex normals are evaluated from the analytic tangents of the surface. Rows
+	/// past the last one are evaluated at the end of the S-range for their normals only.
+	/// @brief Method to write the vertices position of a band of rows into a flat vertices array.
+	/// @param[out] verticesW			The pointer to the writable vertices array. @callerOwnsPointed{vertices array}.
+	/// @param[out] normalsW			The pointer to the writable normals array of the band, nullptr to skip the normals. @callerOwnsPointed{normals array}.
+	/// @param[in] sParams				The reference to the array of S-parameters, one for each vertices row.
+	/// @param[in] rowStart				The reference to the index of the first row of the band.
+	/// @param[in] rowEnd					The reference to the index past the last row of the band.
+	/// @param[in] stepsT					The reference to the number of segments on T between two consecutive curves.
+	/// @param[in] smooth					The reference to the interpolation flag: Catmull-Rom between the curves if true, linear otherwise.
+	/// @param[in] flipFirst			The reference to the invert direction flag on the first curve.
+	/// @param[in] flipSecond			The reference to the invert direction flag on the other curves.
+	/// @param[in] paramFirst			The reference to the parametrization type on the first curve.
+	/// @param[in] paramSecond		The reference to the parametrization type on the other curves.
+	/// @return										True if successful, false otherwise.
+	//------------------------------------------------------------------------------------------------
+	maxon::Result<void> FillVerticesPosition(Vector* verticesW, Vector* normalsW, const maxon::BaseArray<Float> &sParams, const Int32 &rowStart, const Int32 &rowEnd, const Int32 &stepsT, const Bool &smooth, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond);
+
+	//------------------------------------------------------------------------------------------------
+	/// Private method to fill the PolygonObject in bands of rows: the vertices and, if requested, the
+	/// polygon indexes and the surface attributes of each band are written before moving to the next
+	/// one, so that the scratch memory is limited to a single band.
+	/// @brief Method to fill the PolygonObject in bands of rows.
+	/// @param[out] polyObj				The reference to the PolygonObject instance.
+	/// @param[in] segmentsS			The reference to the number of segments on S.
+	/// @param[in] stepsT					The reference to the number of segments on T between two consecutive curves.
+	/// @param[in] closedS				The reference to the boolean closure status along S-direction.
+	/// @param[in] fillPolygons		The reference to the flag to write the polygon indexes and the surface attributes.
+	/// @param[out] uvwTag				The pointer to the UVW tag to fill, nullptr to skip it. @callerOwnsPointed{tag}.
+	/// @param[out] normalTag			The pointer to the Normal tag to fill, nullptr to skip it. @callerOwnsPointed{tag}.
+	/// @param[in] smooth					The reference to the interpolation flag: Catmull-Rom between the curves if true, linear otherwise.
+	/// @param[in] flipFirst			The reference to the invert direction flag on the first curve.
+	/// @param[in] flipSecond			The reference to the invert direction flag on the other curves.
+	/// @param[in] paramFirst			The reference to the parametrization type on the first curve.
+	/// @param[in] paramSecond		The reference to the parametrization type on the other curves.
+	/// @param[in] thread					The pointer to the thread checked for user breaks before every band. @callerOwnsPointed{thread}.
+	/// @return										True if all the bands have been filled, false if interrupted by a user break.
+	//------------------------------------------------------------------------------------------------
+	maxon::Result<Bool> FillBands(PolygonObject &polyObj, const Int32 &segmentsS, const Int32 &stepsT, const Bool &closedS, const Bool &fillPolygons, UVWTag* uvwTag, NormalTag* normalTag, const Bool &smooth, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond, BaseThread* thread);
+
+	//------------------------------------------------------------------------------------------------
+	/// Private method to compute the S-parameters of the vertices rows. In uniform mode the [0, 1] range
+	/// is split in stepsS segments. In adaptive mode the rows are a subset of the uniform ones: segments
+	/// are recursively split, up to stepsS segments, only where the chord error of one of the input
+	/// curves, sampled at the uniform rows inside the segment, exceeds the given tolerance.
+	/// @brief Method to compute the S-parameters of the vertices rows.
+	/// @param[in] stepsS					The reference to the (maximum) number of segments on S.
+	/// @param[in] adaptive				The reference to the adaptive subdivision flag.
+	/// @param[in] tolerance			The reference to the maximum chord error allowed in adaptive mode.
+	/// @param[in] flipFirst			The reference to the invert direction flag on the first curve.
+	/// @param[in] flipSecond			The reference to the invert direction flag on the other curves.
 	/// @param[in] paramFirst			The reference to the parametrization type on the first curve.
-	/// @param[in] paramSecond		The reference to the parametrization type on the second curve.
+	/// @param[in] paramSecond		The reference to the parametrization type on the other curves.
+	/// @param[in] closedS				The reference to the boolean closure status along S-direction: the last row is skipped since it matches the first one.
 	/// @return										True if successful, false otherwise.
 	//------------------------------------------------------------------------------------------------
-	maxon::Result<void> FillVerticesPosition(maxon::BaseArray<maxon::BaseArray<Vector>> &verticesData, const Int32 &stepsS, const Int32 &stepsT, const Bool &firstFlip, const Bool &secondFlip, const Int32 &paramFirst, const Int32 &paramSecond);
+	maxon::Result<void> ComputeSParameters(const Int32 &stepsS, const Bool &adaptive, const Float &tolerance, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond, const Bool &closedS);
 
 	//------------------------------------------------------------------------------------------------
 	/// Private method to check and set the Phong tag for the returned PolygonObject.
@@ -196,11 +384,55 @@ private:
 	maxon::Result<void> CheckAndSetPhongTag(BaseObject *op, PolygonObject *polyObj);
 
 	//------------------------------------------------------------------------------------------------
-	/// Private method to allocate the SplingLengthHelper() instances.
-	/// @brief Method to allocate the SplingLengthHelper() instances.
+	/// Private method to add, resize or remove the UVW and Normal tags of the returned PolygonObject.
+	/// @brief Method to prepare the UVW and Normal tags of the returned PolygonObject.
+	/// @param[in] polyObj				The pointer to the PolygonOjbect isntance. @callerOwnsPointed{polygon object}.
+	/// @param[in] generateUVW		The reference to the UVW generation flag.
+	/// @param[in] generateNormals	The reference to the normals generation flag.
+	/// @param[out] uvwTag				The reference to the pointer to the UVW tag, nullptr if not generated.
+	/// @param[out] normalTag			The reference to the pointer to the Normal tag, nullptr if not generated.
+	/// @return										True if successful, false otherwise.
+	//------------------------------------------------------------------------------------------------
+	maxon::Result<void> PrepareAttributeTags(PolygonObject *polyObj, const Bool &generateUVW, const Bool &generateNormals, UVWTag* &uvwTag, NormalTag* &normalTag);
+
+	//------------------------------------------------------------------------------------------------
+	/// Private method to retrieve the previously generated PolygonObject if its topology can be reused.
+	/// @brief Method to retrieve the cached PolygonObject if its topology matches the requested one.
+	/// @param[in] op							The pointer to the BaseObject instance. @callerOwnsPointed{hierarchy helper}.
+	/// @param[in] hh							The pointer to the HierarchyHelp isntance. @callerOwnsPointed{object}.
+	/// @param[in] stepsS					The reference to the number of segments on S.
+	/// @param[in] stepsT					The reference to the number of segments on T.
+	/// @param[in] closedS				The reference to the boolean closure status along S-direction.
+	/// @return										The cached PolygonObject if its topology can be reused, nullptr otherwise.
+	//------------------------------------------------------------------------------------------------
+	PolygonObject* GetReusableCache(BaseObject* op, HierarchyHelp* hh, const Int32 &stepsS, const Int32 &stepsT, const Bool &closedS);
+
+	//------------------------------------------------------------------------------------------------
+	/// Private method to allocate and initialize the SplineLengthData instances. The instances are kept
+	/// between rebuilds and initialized again only when the dirty checksum of the input curve hierarchy
+	/// changes. Each instance is initialized with its own copy of the cloned curve, kept alive as long as
+	/// the instance, since the clones are released at the end of every rebuild.
+	/// @brief Method to allocate and update (eventually) the SplineLengthData instances.
+	/// @param[in] leaves				The reference to the array of input objects. @callerOwnsPointed{objects}.
+	/// @param[in] paramFirst			The reference to the parametrization type on the first curve.
+	/// @param[in] paramSecond		The reference to the parametrization type on the other curves.
 	/// @return										True if successful, false otherwise.
 	//------------------------------------------------------------------------------------------------
-	maxon::Result<void> AllocateSplineHelpers();
+	maxon::Result<void> UpdateSplineHelpers(const maxon::BaseArray<BaseObject*> &leaves, const Int32 &paramFirst, const Int32 &paramSecond);
+
+	//------------------------------------------------------------------------------------------------
+	/// Private method to evaluate the global position of an input curve using the direction and the
+	/// parametrization settings of the first curve or of the other curves.
+	/// @brief Method to evaluate a point on an input curve.
+	/// @param[in] crvIdx					The reference to the index of the input curve.
+	/// @param[in] sParam					The reference to the parameter along the S-direction in the [0, 1] range.
+	/// @param[in] flipFirst			The reference to the invert direction flag on the first curve.
+	/// @param[in] flipSecond			The reference to the invert direction flag on the other curves.
+	/// @param[in] paramFirst			The reference to the parametrization type on the first curve.
+	/// @param[in] paramSecond		The reference to the parametrization type on the other curves.
+	/// @return										The global position of the point on the curve.
+	//------------------------------------------------------------------------------------------------
+	Vector GetPointOnInputCurve(const Int &crvIdx, const Float &sParam, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond) const;
 
 	//------------------------------------------------------------------------------------------------
 	/// Private method used before returning from GVO to release all the allocated resources.
@@ -209,11 +441,30 @@ private:
 	//------------------------------------------------------------------------------------------------
 	maxon::Result<void> FreeResources();
 
+	/// SplineLengthHelper kept between rebuilds for an input curve.
+	struct CurveHelper
+	{
+		SplineLengthData* lengthHelper;						/// Pointer to the SplineLengthHelper used to calculate the spline point position
+		SplineObject* spline;											/// Pointer to the copy of the curve the SplineLengthHelper has been initialized with
+		const BaseObject* leaf;										/// Pointer to the input object the SplineLengthHelper has been initialized with
+		UInt64 dirty;															/// Dirty checksum of the input object hierarchy the SplineLengthHelper has been initialized with
+	};
+
 private:
-	BaseObject *_clonedObjs;										/// Pointer to the BaseObject resulting from GetAndCheckHierarchyClone()
-	SplineObject *_firstCrv, *_secondCrv;				/// Pointers to the SplineObject(s) found in the cloned null object
-	SplineLengthData *_firstCurveLengthHelper,	/// Pointers to the SplineLengthHelpers used to calculate the spline point position
-		*_secondCurveLengthHelper;
+	BaseObject *_clonedObjs;										/// Pointer to the null object holding the clones made by GetClonedCurves()
+	maxon::BaseArray<BaseObject*> _leaves;			/// Pointers to the input objects used by the generator
+	maxon::BaseArray<SplineObject*> _crvs;			/// Pointers to the SplineObject(s) found in the cloned null object
+	maxon::BaseArray<Matrix> _crvMtxs;					/// Local transformations of the SplineObject(s) found in the cloned null object
+	maxon::BaseArray<CurveHelper> _crvHelpers;	/// SplineLengthHelpers of the input curves, one for each curve position
+	maxon::BaseArray<Vector> _crvPoints;				/// Points sampled on the curves for every vertices row, kept to avoid reallocations between rebuilds
+	maxon::BaseArray<Vector> _vertexNormals;		/// Normals of the vertices of the current band, kept to avoid reallocations between rebuilds
+	Int32 _topologyStepsS, _topologyStepsT;			/// S/T segmentation used to build the polygon indexes of the cached PolygonObject
+	Bool _topologyClosedS;											/// S-direction closure status used to build the polygon indexes of the cached PolygonObject
+	maxon::BaseArray<Float> _sParams;						/// S-parameters of the vertices rows, kept to avoid reallocations between rebuilds
+	Vector _bboxMin, _bboxMax;									/// Bounding box of the vertices generated during the last rebuild
+	Bool _bboxValid;														/// Validity status of the stored bounding box
+	Int32 _lodContext;													/// Context the current cache of the generator has been built for
+	RuledMeshPhaseStats* _phaseStats;						/// Statistics filled by the current rebuild when benchmarking, nullptr otherwise
 };
 
 /// @name ObjectData functions
@@ -221,10 +472,14 @@ private:
 Bool RuledMesh::Init(GeListNode* node)
 {
 	_clonedObjs = nullptr;
-	_firstCrv = nullptr;
-	_secondCrv = nullptr;
-	_firstCurveLengthHelper = nullptr;
-	_secondCurveLengthHelper = nullptr;
+	_topologyStepsS = 0;
+	_topologyStepsT = 0;
+	_topologyClosedS = false;
+	_bboxMin.SetZero();
+	_bboxMax.SetZero();
+	_bboxValid = false;
+	_lodContext = RULEDMESH_LOD_EDITOR;
+	_phaseStats = nullptr;
 
 	// Check the provided input pointer.
 	if (!node)
@@ -241,16 +496,42 @@ Bool RuledMesh::Init(GeListNode* node)
 		return false;
 
 	// Set the values for the different parameters of the generator.
+	bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_MODE, SDK_EXAMPLE_RULEDMESH_MODE_RULED);
 	bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_S_STEPS, 5);
 	bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_T_STEPS, 5);
+	bcPtr->SetBool(SDK_EXAMPLE_RULEDMESH_RENDER_LOD, false);
+	bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_RENDER_S_STEPS, 20);
+	bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_RENDER_T_STEPS, 20);
 	bcPtr->SetBool(SDK_EXAMPLE_RULEDMESH_FLIP_FIRST, false);
 	bcPtr->SetBool(SDK_EXAMPLE_RULEDMESH_FLIP_SECOND, false);
 	bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_PARAM_FIRST, SDK_EXAMPLE_RULEDMESH_PARAM_NATURAL);
 	bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_PARAM_SECOND, SDK_EXAMPLE_RULEDMESH_PARAM_NATURAL);
+	bcPtr->SetBool(SDK_EXAMPLE_RULEDMESH_ADAPTIVE, false);
+	bcPtr->SetFloat(SDK_EXAMPLE_RULEDMESH_ADAPTIVE_TOLERANCE, 1.0);
 
 	return true;
 }
 
+void RuledMesh::Free(GeListNode* node)
+{
+	// Release the SplineLengthHelpers kept between the rebuilds.
+	for (CurveHelper& crvHelper : _crvHelpers)
+	{
+		if (crvHelper.lengthHelper)
+		{
+			SplineLengthData::Free(crvHelper.lengthHelper);
+			DebugAssert(crvHelper.lengthHelper == nullptr);
+		}
+		if (crvHelper.spline)
+		{
+			SplineObject::Free(crvHelper.spline);
+			DebugAssert(crvHelper.spline == nullptr);
+		}
+	}
+
+	_crvHelpers.Reset();
+}
+
 Bool RuledMesh::Message(GeListNode* node, Int32 type, void* data)
 {
 	if (type == MSG_MENUPREPARE)
@@ -259,6 +540,22 @@ Bool RuledMesh::Message(GeListNode* node, Int32 type, void* data)
 	return SUPER::Message(node, type, data);
 }
 
+Bool RuledMesh::GetDEnabling(GeListNode* node, const DescID& id, const GeData& t_data, DESCFLAGS_ENABLE flags, const BaseContainer* itemdesc)
+{
+	if (!node)
+		return false;
+
+	// Enable the render steps only if they are used.
+	const Int32 paramId = id[0].id;
+	if (paramId == SDK_EXAMPLE_RULEDMESH_RENDER_S_STEPS || paramId == SDK_EXAMPLE_RULEDMESH_RENDER_T_STEPS)
+	{
+		BaseContainer* bcPtr = static_cast<BaseObject*>(node)->GetDataInstance();
+		return bcPtr && bcPtr->GetBool(SDK_EXAMPLE_RULEDMESH_RENDER_LOD);
+	}
+
+	return SUPER::GetDEnabling(node, id, t_data, flags, itemdesc);
+}
+
 void RuledMesh::GetDimension(BaseObject* op, Vector* mp, Vector* rad)
 {
 	// Check the provided pointers.
@@ -268,46 +565,107 @@ void RuledMesh::GetDimension(BaseObject* op, Vector* mp, Vector* rad)
 	// Reset the radius and center vectors.
 	mp->SetZero();
 	rad->SetZero();
+
+	// Return the bounding box of the vertices generated during the last rebuild, it also covers the
+	// smooth loft overshooting the input curves.
+	if (!_bboxValid)
+		return;
+
+	*mp = (_bboxMin + _bboxMax) * 0.5;
+	*rad = (_bboxMax - _bboxMin) * 0.5;
 }
 
 BaseObject* RuledMesh::GetVirtualObjects(BaseObject *op, HierarchyHelp *hh)
 {
+	// NOTE: every path returning a null object instead of a generated mesh has to invalidate the
+	// bounding box returned by GetDimension().
 	iferr_scope_handler
 	{
+		_bboxValid = false;
 		return BaseObject::Alloc(Onull);
 	};
 	
 	// Check the provided pointers.
 	if (!op || !hh)
+	{
+		_bboxValid = false;
 		return BaseObject::Alloc(Onull);
+	}
 	
-	// Check the presence of two children curves needed to run the generator.
-	if (!op->GetDown())
+	// Retrieve the BaseContainer associated check it
+	BaseContainer* bcPtr = op->GetDataInstance();
+	if (!bcPtr)
+	{
+		_bboxValid = false;
 		return BaseObject::Alloc(Onull);
+	}
 	
-	BaseObject* firstLeaf = op->GetDown();
-	BaseObject* secondLeaf = firstLeaf->GetNext();
-	if (!secondLeaf)
-		return BaseObject::Alloc(Onull);
+#ifdef RULEDMESH_BENCHMARK
+	// Only the generator measured by the benchmark collects the statistics of its phases.
+	_phaseStats = GetRuledMeshPhaseStats(op);
+#endif
+	
+	// Collect the input curves: the ruled mode connects the first two children only whilst the loft
+	// modes connect all the children in the hierarchy order.
+	const Int32 mode = bcPtr->GetInt32(SDK_EXAMPLE_RULEDMESH_MODE);
+	const Int maxCurvesCount = mode == SDK_EXAMPLE_RULEDMESH_MODE_RULED ? 2 : maxon::LIMIT<Int>::MAX;
+	
+	_leaves.Flush();
+	for (BaseObject* leaf = op->GetDown(); leaf && _leaves.GetCount() < maxCurvesCount; leaf = leaf->GetNext())
+		_leaves.Append(leaf) iferr_return;
 	
-	Bool cloneIsDirty = false;
-	iferr (GetFirstAndSecondClonedCurves(op, hh, cloneIsDirty, firstLeaf))
+	// Check the presence of (at least) two children curves needed to run the generator.
+	if (_leaves.GetCount() < 2)
 	{
-		FreeResources() iferr_return;
+		_bboxValid = false;
+		return BaseObject::Alloc(Onull);
 	}
 	
-	if (!cloneIsDirty)
+	// Detect the render context: if separate render steps are used, the steps are picked from the build
+	// flags. Renders evaluate a clone of the document, so each generator instance usually sees a single
+	// context and no result is kept for the other one.
+	const Bool rendering = (hh->GetBuildFlags() & (BUILDFLAGS::INTERNALRENDERER | BUILDFLAGS::EXTERNALRENDERER)) != BUILDFLAGS::NONE;
+	const Int32 lodContext = (rendering && bcPtr->GetBool(SDK_EXAMPLE_RULEDMESH_RENDER_LOD)) ? RULEDMESH_LOD_RENDER : RULEDMESH_LOD_EDITOR;
+	
+	// Check the dirty status of the generator and of the input curves before cloning anything: if
+	// nothing has changed and the context is the same the cache is returned straight away.
+	const Bool contextSwitch = lodContext != _lodContext;
+	const Bool dirty = IsDirty(op, hh, _leaves);
+	if (!dirty && !contextSwitch)
 		return op->GetCache(hh);
 	
-	// Retrieve the BaseContainer associated check it
-	BaseContainer* bcPtr = op->GetDataInstance();
-	if (!bcPtr)
+	// The stored bounding box belongs to the cache being replaced: it is valid again only once a new
+	// mesh has been generated.
+	_bboxValid = false;
+	
+	// The topology of the cached PolygonObject belongs to the outgoing context.
+	if (contextSwitch)
+	{
+		_lodContext = lodContext;
+		_topologyStepsS = 0;
+		_topologyStepsT = 0;
+	}
+	
+	// The input is cloned also on a context switch since the cache belongs to the other context.
+	maxon::TimeValue phaseStart = StartPhase(_phaseStats);
+	iferr (GetClonedCurves(op, hh, _leaves))
 	{
 		FreeResources() iferr_return;
+		return BaseObject::Alloc(Onull);
 	}
-	// Retrieve the number of subdivisions which every of the two splines will be subdivided in.
-	const Int32 stepsS = bcPtr->GetInt32(SDK_EXAMPLE_RULEDMESH_S_STEPS);
-	const Int32 stepsT = bcPtr->GetInt32(SDK_EXAMPLE_RULEDMESH_T_STEPS);
+	
+	if (_phaseStats)
+	{
+		Int64 clonedBytes = 0;
+		for (SplineObject* crv : _crvs)
+			clonedBytes += Int64(crv->GetPointCount()) * Int64(sizeof(Vector) + (crv->GetTangentR() ? sizeof(Tangent) : 0));
+		EndPhase(_phaseStats, RULEDMESH_PHASE_HIERARCHYCLONE, phaseStart, clonedBytes);
+	}
+	
+	// Retrieve the number of subdivisions which every of the splines will be subdivided in.
+	const Bool renderSteps = lodContext == RULEDMESH_LOD_RENDER;
+	const Int32 stepsS = bcPtr->GetInt32(renderSteps ? SDK_EXAMPLE_RULEDMESH_RENDER_S_STEPS : SDK_EXAMPLE_RULEDMESH_S_STEPS);
+	const Int32 stepsT = bcPtr->GetInt32(renderSteps ? SDK_EXAMPLE_RULEDMESH_RENDER_T_STEPS : SDK_EXAMPLE_RULEDMESH_T_STEPS);
 	
 	// Retrieve the flip flags for the two curves
 	const Bool flipFirst = bcPtr->GetBool(SDK_EXAMPLE_RULEDMESH_FLIP_FIRST);
@@ -316,47 +674,131 @@ BaseObject* RuledMesh::GetVirtualObjects(BaseObject *op, HierarchyHelp *hh)
 	const Int32 paramFirst = bcPtr->GetInt32(SDK_EXAMPLE_RULEDMESH_PARAM_FIRST);
 	const Int32 paramSecond = bcPtr->GetInt32(SDK_EXAMPLE_RULEDMESH_PARAM_SECOND);
 	
-	iferr (AllocateSplineHelpers())
+	// Retrieve the adaptive subdivision settings along S.
+	const Bool adaptive = bcPtr->GetBool(SDK_EXAMPLE_RULEDMESH_ADAPTIVE);
+	const Float tolerance = bcPtr->GetFloat(SDK_EXAMPLE_RULEDMESH_ADAPTIVE_TOLERANCE);
+	
+	// Retrieve the surface attributes to be generated along with the geometry.
+	const Bool generateUVW = bcPtr->GetBool(SDK_EXAMPLE_RULEDMESH_GENERATE_UVW);
+	const Bool generateNormals = bcPtr->GetBool(SDK_EXAMPLE_RULEDMESH_GENERATE_NORMALS);
+	
+	phaseStart = StartPhase(_phaseStats);
+	iferr (UpdateSplineHelpers(_leaves, paramFirst, paramSecond))
 	{
 		FreeResources() iferr_return;
+		return BaseObject::Alloc(Onull);
 	}
 	
-	// Define the resulting polygon mesh parameters and allocate the object.
-	const Int32 vertexesCount = (stepsS + 1) * (stepsT + 1);
-	const Int32 polysCount = stepsS * stepsT;
+	// Compute the S-parameters of the vertices rows.
+	// Detect the closure of the input curves: if all the curves are closed the mesh wraps around along
+	// S sharing the first vertices row instead of duplicating it (at least three rows are required).
+	Bool closedS = stepsS > 2;
+	for (SplineObject* crv : _crvs)
+		closedS = closedS && crv->IsClosed();
 	
-	// Allocate the PolygonObject used to return the geometry of the generator
-	PolygonObject* polyObj = PolygonObject::Alloc(vertexesCount, polysCount);
-	// check the allocated PolygonObject
-	if (!polyObj)
+	iferr (ComputeSParameters(stepsS, adaptive, tolerance, flipFirst, flipSecond, paramFirst, paramSecond, closedS))
 	{
 		FreeResources() iferr_return;
+		return BaseObject::Alloc(Onull);
 	}
 	
-	// Allocate a 2-dim BaseArray to store vertices position.
-	maxon::BaseArray<maxon::BaseArray<Vector>> verticesBA;
+	EndPhase(_phaseStats, RULEDMESH_PHASE_SPLINEHELPERS, phaseStart, _sParams.GetCount() * sizeof(Float));
+	
+	// Retrieve the effective number of segments on S and on T, the latter spanning all the curves.
+	const Int32 segmentsS = closedS ? Int32(_sParams.GetCount()) : Int32(_sParams.GetCount()) - 1;
+	const Int32 segmentsT = Int32(_crvs.GetCount() - 1) * stepsT;
+	const Bool smooth = mode == SDK_EXAMPLE_RULEDMESH_MODE_LOFT_SMOOTH;
+	
+	// Define the resulting polygon mesh parameters.
+	const Int32 vertexesCount = Int32(_sParams.GetCount()) * (segmentsT + 1);
+	const Int32 polysCount = segmentsS * segmentsT;
 	
-	// Resize the 2-dim BaseArray to store the computed position for the vertices.
-	//	if (!ResizeVerticesBaseArray(verticesBA, stepsS + 1, stepsT + 1))
-	iferr (ResizeVerticesBaseArray(verticesBA, stepsS + 1, stepsT + 1))
+	UVWTag* uvwTag = nullptr;
+	NormalTag* normalTag = nullptr;
+	
+	// When only the curves shape has changed the topology of the cached PolygonObject is still valid:
+	// update the vertices position in place and keep the polygon indexes.
+	PolygonObject* cachedPolyObj = GetReusableCache(op, hh, segmentsS, segmentsT, closedS);
+	if (cachedPolyObj)
+	{
+		iferr (PrepareAttributeTags(cachedPolyObj, generateUVW, generateNormals, uvwTag, normalTag))
+		{
+			FreeResources() iferr_return;
+			return BaseObject::Alloc(Onull);
+		}
+
+		// The surface attributes depend on the vertices and on the rows parameters: refill them in the
+		// same pass writing the (unchanged) polygon indexes.
+		iferr (const Bool completed = FillBands(*cachedPolyObj, segmentsS, stepsT, closedS, uvwTag || normalTag, uvwTag, normalTag, smooth, flipFirst, flipSecond, paramFirst, paramSecond, hh->GetThread()))
+		{
+			_topologyStepsS = _topologyStepsT = 0;
+			FreeResources() iferr_return;
+			return BaseObject::Alloc(Onull);
+		}
+
+		// A user break leaves the cached PolygonObject partially rewritten: invalidate the topology key
+		// so that the next rebuild allocates a new mesh rather than reusing it.
+		if (!completed)
+			_topologyStepsS = _topologyStepsT = 0;
+
+		cachedPolyObj->Message(MSG_UPDATE);
+
+		// Store the bounding box of the generated vertices to be returned by GetDimension().
+		_bboxValid = ComputeVerticesBoundingBox(*cachedPolyObj, _bboxMin, _bboxMax);
+
+		phaseStart = StartPhase(_phaseStats);
+		CheckAndSetPhongTag(op, cachedPolyObj) iferr_return;
+		EndPhase(_phaseStats, RULEDMESH_PHASE_PHONGTAG, phaseStart);
+
+		// Deallocate all the local objects.
+		FreeResources() iferr_return;
+		return cachedPolyObj;
+	}
+
+	// Allocate the PolygonObject used to return the geometry of the generator
+	phaseStart = StartPhase(_phaseStats);
+	PolygonObject* polyObj = PolygonObject::Alloc(vertexesCount, polysCount);
+	// check the allocated PolygonObject
+	if (!polyObj)
 	{
 		FreeResources() iferr_return;
+		return BaseObject::Alloc(Onull);
 	}
 	
-	iferr (FillVerticesPosition(verticesBA, stepsS, stepsT, flipFirst, flipSecond, paramFirst, paramSecond))
+	// Add the tags storing the surface attributes.
+	iferr (PrepareAttributeTags(polyObj, generateUVW, generateNormals, uvwTag, normalTag))
 	{
+		PolygonObject::Free(polyObj);
 		FreeResources() iferr_return;
+		return BaseObject::Alloc(Onull);
 	}
 	
-	// Populate the PolygonObject with the computed position of the vertices.
-	iferr (FillPolygonObjectData(*polyObj, stepsS + 1, stepsT + 1, hh, verticesBA))
+	// The Normal tag stores 12 compressed components per polygon.
+	EndPhase(_phaseStats, RULEDMESH_PHASE_MESHALLOCATION, phaseStart, Int64(vertexesCount) * sizeof(Vector) + Int64(polysCount) * Int64(sizeof(CPolygon) + (uvwTag ? sizeof(UVWStruct) : 0) + (normalTag ? 12 * sizeof(Int16) : 0)));
+	
+	// Compute the vertices position, the polygon indexes and the surface attributes band by band
+	// directly into the PolygonObject.
+	iferr (const Bool completed = FillBands(*polyObj, segmentsS, stepsT, closedS, true, uvwTag, normalTag, smooth, flipFirst, flipSecond, paramFirst, paramSecond, hh->GetThread()))
 	{
+		PolygonObject::Free(polyObj);
 		FreeResources() iferr_return;
+		return BaseObject::Alloc(Onull);
 	}
 	
+	// Store the segmentation the polygon indexes have been built for unless the filling has been
+	// interrupted by a user break leaving the indexes incomplete.
+	_topologyStepsS = completed ? segmentsS : 0;
+	_topologyStepsT = completed ? segmentsT : 0;
+	_topologyClosedS = closedS;
+	
 	polyObj->Message(MSG_UPDATE);
 	
+	// Store the bounding box of the generated vertices to be returned by GetDimension().
+	_bboxValid = ComputeVerticesBoundingBox(*polyObj, _bboxMin, _bboxMax);
+	
+	phaseStart = StartPhase(_phaseStats);
 	CheckAndSetPhongTag(op, polyObj) iferr_return;
+	EndPhase(_phaseStats, RULEDMESH_PHASE_PHONGTAG, phaseStart);
 	
 	// Deallocate all the local objects.
 	FreeResources() iferr_return;
@@ -372,96 +814,331 @@ maxon::Result<void> RuledMesh::FreeResources()
 		DebugAssert(_clonedObjs == nullptr);
 	}
 
-	if (_firstCurveLengthHelper)
+	// The cloned curves have been released with their null object.
+	_crvs.Flush();
+	_crvMtxs.Flush();
+
+	return maxon::OK;
+}
+
+Bool RuledMesh::IsDirty(BaseObject* op, HierarchyHelp* hh, const maxon::BaseArray<BaseObject*> &leaves)
+{
+	if (!op || !hh)
+		return true;
+
+	// Collect the dirty counts of the input curves and of the objects below them, the same objects
+	// GetHierarchyClone() evaluates when cloning the curves.
+	op->NewDependenceList();
+	for (BaseObject* leaf : leaves)
+		ForEachObjectInHierarchy(leaf, [op, hh](BaseObject* obj) { op->AddDependence(hh, obj); });
+
+	// Check the generator cache and parameters and compare the dirty counts of the input curves
+	// with the ones stored during the previous evaluation.
+	const Bool dirty = op->CheckCache(hh) || op->IsDirty(DIRTYFLAGS::DATA) || !op->CompareDependenceList();
+	if (!dirty)
+		op->TouchDependenceList();
+
+	return dirty;
+}
+
+maxon::Result<void> RuledMesh::GetClonedCurves(BaseObject* op, HierarchyHelp* hh, const maxon::BaseArray<BaseObject*> &leaves)
+{
+	iferr_scope;
+
+	if (!op || !hh)
+		return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+	
+	// Clone the input objects one by one under a null object as GetAndCheckHierarchyClone() does: the
+	// dirty state has already been checked by IsDirty() and GetAndCheckHierarchyClone() would also
+	// clone and touch the children which are not used as curves.
+	_clonedObjs = BaseObject::Alloc(Onull);
+	if (!_clonedObjs)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate the null object"_s);
+
+	for (BaseObject* leaf : leaves)
 	{
-		SplineLengthData::Free(_firstCurveLengthHelper);
-		DebugAssert(_firstCurveLengthHelper == nullptr);
+		BaseObject* clonedChild = op->GetHierarchyClone(hh, leaf, HIERARCHYCLONEFLAGS::ASIS, nullptr, nullptr);
+		if (!clonedChild)
+			return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate memory in GetHierarchyClone"_s);
+		clonedChild->InsertUnderLast(_clonedObjs);
 	}
 
-	if (_secondCurveLengthHelper)
+	_crvs.Flush();
+	_crvMtxs.Flush();
+	_crvs.EnsureCapacity(leaves.GetCount()) iferr_return;
+	_crvMtxs.EnsureCapacity(leaves.GetCount()) iferr_return;
+
+	// NOTE: The cloned children are placed under the clonedObjs (which is a null object) in the same
+	// order of the input objects.
+	BaseObject* clonedChild = _clonedObjs->GetDown();
+	for (Int i = 0; i < leaves.GetCount(); ++i)
 	{
-		SplineLengthData::Free(_secondCurveLengthHelper);
-		DebugAssert (_secondCurveLengthHelper == nullptr);
+		if (!clonedChild)
+			return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed accessing input curve"_s);
+
+		SplineObject* crv = clonedChild->GetRealSpline();
+		if (!crv)
+			return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Input object is not a curve"_s);
+
+		_crvs.Append(crv) iferr_return;
+		_crvMtxs.Append(crv->GetMl()) iferr_return;
+
+		clonedChild = clonedChild->GetNext();
 	}
 
 	return maxon::OK;
 }
 
-maxon::Result<void> RuledMesh::GetFirstAndSecondClonedCurves(BaseObject* op, HierarchyHelp* hh, Bool &dirtyFlag, BaseObject* firstChild)
+maxon::Result<void> RuledMesh::ComputeSParameters(const Int32 &stepsS, const Bool &adaptive, const Float &tolerance, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond, const Bool &closedS)
 {
-	if (!op || !hh)
-		return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
-	
-	_clonedObjs = op->GetAndCheckHierarchyClone(hh, firstChild, HIERARCHYCLONEFLAGS::ASIS, &dirtyFlag, nullptr, true);
-	if (!dirtyFlag)
+	iferr_scope;
+
+	// Reuse the memory allocated during the previous rebuilds.
+	_sParams.Flush();
+
+	const Float sStep = 1.0 / Float(stepsS);
+
+	// On closed curves the last row would duplicate the first one.
+	const Int32 rowsS = closedS ? stepsS : stepsS + 1;
+
+	if (!adaptive)
+	{
+		_sParams.EnsureCapacity(rowsS) iferr_return;
+		for (Int32 s = 0; s < rowsS; ++s)
+			_sParams.Append(Float(s) * sStep) iferr_return;
 		return maxon::OK;
+	}
 
-	// Something has failed in GetAndCheckHierarchyClone()
-	if (!_clonedObjs)
-		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate memory in GetAndCheckHierachyClone"_s);
+	// Evaluate the chord error of all the curves on the interval between two S-steps: the curves are
+	// sampled at every S-step strictly inside the interval, i.e. at the parameters a finer subdivision
+	// would place vertices rows at, and compared with the linear interpolation of the interval ends.
+	auto exceedsTolerance = [&](Int32 firstStep, Int32 lastStep) -> Bool
+	{
+		for (Int crvIdx = 0; crvIdx < _crvs.GetCount(); ++crvIdx)
+		{
+			const Vector start = GetPointOnInputCurve(crvIdx, Float(firstStep) * sStep, flipFirst, flipSecond, paramFirst, paramSecond);
+			const Vector end = GetPointOnInputCurve(crvIdx, Float(lastStep) * sStep, flipFirst, flipSecond, paramFirst, paramSecond);
+
+			for (Int32 step = firstStep + 1; step < lastStep; ++step)
+			{
+				const Float blend = Float(step - firstStep) / Float(lastStep - firstStep);
+				const Vector chord = start + (end - start) * blend;
+				const Vector point = GetPointOnInputCurve(crvIdx, Float(step) * sStep, flipFirst, flipSecond, paramFirst, paramSecond);
+				if ((point - chord).GetLength() > tolerance)
+					return true;
+			}
+		}
+
+		return false;
+	};
+
+	// Start from a coarse subdivision and split the intervals depth-first so that the parameters are
+	// appended in increasing order. The intervals are bounded by S-steps, so the finest subdivision
+	// is the uniform one with stepsS segments.
+	struct Interval
+	{
+		Int32 firstStep, lastStep;
+	};
+
+	const Int32 initialSegments = maxon::Min(stepsS, Int32(4));
+	maxon::BaseArray<Interval> intervals;
+
+	for (Int32 i = initialSegments - 1; i >= 0; --i)
+		intervals.Append(Interval{ i * stepsS / initialSegments, (i + 1) * stepsS / initialSegments }) iferr_return;
+
+	Interval interval;
+	while (intervals.Pop(&interval))
+	{
+		// An interval of a single S-step is at the maximum resolution.
+		if (interval.lastStep - interval.firstStep >= 2 && exceedsTolerance(interval.firstStep, interval.lastStep))
+		{
+			const Int32 midStep = (interval.firstStep + interval.lastStep) / 2;
+			intervals.Append(Interval{ midStep, interval.lastStep }) iferr_return;
+			intervals.Append(Interval{ interval.firstStep, midStep }) iferr_return;
+			continue;
+		}
 
-	// NOTE: The cloned children are placed under the clonedObjs (which is a null object)
-	_firstCrv = static_cast<SplineObject*>(_clonedObjs->GetDown());
-	if (!_firstCrv)
-		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed accessing first curve"_s);
-	_firstCrv = _firstCrv->GetRealSpline();
+		_sParams.Append(Float(interval.firstStep) * sStep) iferr_return;
+	}
 
-	_secondCrv = static_cast<SplineObject*>(_clonedObjs->GetDown()->GetNext());
-	if (!_secondCrv)
-		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed accessing second curve"_s);
-	_secondCrv = _secondCrv->GetRealSpline();
+	if (!closedS)
+		_sParams.Append(1.0) iferr_return;
 
 	return maxon::OK;
 }
 
-maxon::Result<void> RuledMesh::FillVerticesPosition(maxon::BaseArray<maxon::BaseArray<Vector>> &verticesData, const Int32 &stepsS, const Int32 &stepsT, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond)
+maxon::Result<void> RuledMesh::FillVerticesPosition(Vector* verticesW, Vector* normalsW, const maxon::BaseArray<Float> &sParams, const Int32 &rowStart, const Int32 &rowEnd, const Int32 &stepsT, const Bool &smooth, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond)
 {
-	// Retrieve the local transformation for both cloned children
-	Matrix firstLocalMtx = _firstCrv->GetMl();
-	Matrix secondLocalMtx = _secondCrv->GetMl();
-	
-	
-	const Float sStep = 1.0f / float(stepsS);
-	const Float tStep = 1.0f / float(stepsT);
+	iferr_scope;
+
+	if (!verticesW)
+		return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+	const Int crvsCount = _crvs.GetCount();
+	const Int32 spansCount = Int32(crvsCount) - 1;
+	if (spansCount < 1)
+		return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+	const Float tStep = 1.0 / Float(stepsT);
+	const Int32 vertsAlongT = spansCount * stepsT + 1;
+
+	// Reserve the memory storing the points sampled on the curves for every row of the band, followed
+	// by their derivatives along S when the normals are requested.
+	const Int rowsCount = sParams.GetCount();
+	const Int rowPointsCount = normalsW ? 2 * crvsCount : crvsCount;
+	_crvPoints.Resize((rowEnd - rowStart) * rowPointsCount) iferr_return;
+	Vector* crvPointsW = _crvPoints.GetFirst();
+
+	// Express the span between two consecutive curves as a cubic in the local parameter: linear for
+	// the ruled spans, Catmull-Rom (reflecting the end curves) for the smooth loft. The same basis
+	// applies to the derivatives along S of the curves.
+	auto spanCoefficients = [&](const Vector* points, Int32 span, Vector& c1, Vector& c2, Vector& c3)
+	{
+		const Vector& p1 = points[span];
+		const Vector& p2 = points[span + 1];
+		c1 = p2 - p1;
+		c2 = c3 = Vector();
+		if (smooth)
+		{
+			const Vector p0 = span > 0 ? points[span - 1] : p1 * 2.0 - p2;
+			const Vector p3 = span < spansCount - 1 ? points[span + 2] : p2 * 2.0 - p1;
+			c1 = (p2 - p0) * 0.5;
+			c2 = p0 - p1 * 2.5 + p2 * 2.0 - p3 * 0.5;
+			c3 = (p3 - p0) * 0.5 + (p1 - p2) * 1.5;
+		}
+	};
+
+	// Step used to evaluate the curves derivatives along S by central differences.
+	const Float sDelta = 1e-4;
 	
-	Int32 s, t;
-	for (s = 0; s < (stepsS + 1); ++s)
+	// Every S-row only depends on the curves: the rows of the band are spread over the available
+	// worker threads. The workers share the curves and the SplineLengthData instances read-only:
+	// GetSplinePoint() and UniformToNatural() only read the data computed when the curves have been
+	// cloned and the helpers initialized, and each helper refers to its own copy of the curve.
+	auto fillRow = [&](Int s)
 	{
-		Float sParam = (Float)s * sStep;
-		Float abscissaA = sParam;
-		Float abscissaB = sParam;
-		
-		// Check if the curve has been flipped and accordingly change the param value.
-		if (flipFirst)
-			abscissaA = 1.0f - abscissaA;
-		if (flipSecond)
-			abscissaB = 1.0f - abscissaB;
-		
-		// Check the parametrization of the curves and modify the abscissa accordingly
-		if (paramFirst == SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM)
-			abscissaA = _firstCurveLengthHelper->UniformToNatural(abscissaA);
-		if (paramSecond == SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM)
-			abscissaB = _secondCurveLengthHelper->UniformToNatural(abscissaB);
-		
-		// Retrieve the position of the point at the i-th step on the splines object.
-		Vector pointOnFirstCurve = _firstCrv->GetSplinePoint(abscissaA);
-		Vector pointOnSecondCurve = _secondCrv->GetSplinePoint(abscissaB);
-		
-		// Transform the point in global coordinates.
-		pointOnFirstCurve = firstLocalMtx * pointOnFirstCurve;
-		pointOnSecondCurve = secondLocalMtx * pointOnSecondCurve;
-		
-		// Fill the vertices's positions of the resulting ruled mesh
-		for (t = 0; t < (stepsT + 1); ++t)
+		const Float sParam = s < rowsCount ? sParams[s] : 1.0;
+
+		// Retrieve the position of the points at the s-th row on the splines object.
+		Vector* rowPoints = crvPointsW + (s - rowStart) * rowPointsCount;
+		for (Int crvIdx = 0; crvIdx < crvsCount; ++crvIdx)
+			rowPoints[crvIdx] = GetPointOnInputCurve(crvIdx, sParam, flipFirst, flipSecond, paramFirst, paramSecond);
+
+		// Rows past the last one only provide their normals.
+		Vector* rowW = s < rowsCount ? verticesW + s * vertsAlongT : nullptr;
+		for (Int32 span = 0; span < spansCount && rowW; ++span)
 		{
-			Float tParam = t * tStep;
-			verticesData[s][t] = (1 - tParam)*pointOnFirstCurve + tParam*pointOnSecondCurve;
+			Vector c1, c2, c3;
+			spanCoefficients(rowPoints, span, c1, c2, c3);
+
+			// Fill the vertices's positions of the span: the loop has no dependencies between iterations
+			// and can be vectorized by the compiler.
+			const Vector& p1 = rowPoints[span];
+			Vector* spanW = rowW + span * stepsT;
+			for (Int32 t = 0; t < stepsT; ++t)
+			{
+				const Float u = Float(t) * tStep;
+				spanW[t] = p1 + (c1 + (c2 + c3 * u) * u) * u;
+			}
 		}
-	}
+
+		// The last vertex of the row lies on the last curve.
+		if (rowW)
+			rowW[vertsAlongT - 1] = rowPoints[spansCount];
+
+		if (!normalsW)
+			return;
+
+		// Retrieve the derivatives along S of the curves at the s-th row.
+		const Float sPrev = maxon::Max(sParam - sDelta, Float(0.0));
+		const Float sNext = maxon::Min(sParam + sDelta, Float(1.0));
+		Vector* rowDerivs = rowPoints + crvsCount;
+		for (Int crvIdx = 0; crvIdx < crvsCount; ++crvIdx)
+		{
+			const Vector prev = GetPointOnInputCurve(crvIdx, sPrev, flipFirst, flipSecond, paramFirst, paramSecond);
+			const Vector next = GetPointOnInputCurve(crvIdx, sNext, flipFirst, flipSecond, paramFirst, paramSecond);
+			rowDerivs[crvIdx] = (next - prev) / (sNext - sPrev);
+		}
+
+		// The normal is the cross product of the surface tangents along S and along T, the latter
+		// being the derivative of the span cubic.
+		Vector* rowNormalsW = normalsW + (s - rowStart) * vertsAlongT;
+		for (Int32 span = 0; span < spansCount; ++span)
+		{
+			Vector c1, c2, c3, d1, d2, d3;
+			spanCoefficients(rowPoints, span, c1, c2, c3);
+			spanCoefficients(rowDerivs, span, d1, d2, d3);
+
+			const Vector& q1 = rowDerivs[span];
+			const Int32 lastT = span == spansCount - 1 ? stepsT : stepsT - 1;
+			for (Int32 t = 0; t <= lastT; ++t)
+			{
+				const Float u = Float(t) * tStep;
+				const Vector tangentS = q1 + (d1 + (d2 + d3 * u) * u) * u;
+				const Vector tangentT = c1 + (c2 * 2.0 + c3 * (3.0 * u)) * u;
+				rowNormalsW[span * stepsT + t] = Cross(tangentS, tangentT).GetNormalized();
+			}
+		}
+	};
+
+	maxon::ParallelFor::Dynamic(rowStart, rowEnd, fillRow);
 	
 	return maxon::OK;
 }
 
+maxon::Result<Bool> RuledMesh::FillBands(PolygonObject &polyObj, const Int32 &segmentsS, const Int32 &stepsT, const Bool &closedS, const Bool &fillPolygons, UVWTag* uvwTag, NormalTag* normalTag, const Bool &smooth, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond, BaseThread* thread)
+{
+	iferr_scope;
+
+	Vector* verticesW = polyObj.GetPointW();
+	if (!verticesW)
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to access vertices array"_s);
+
+	const Int32 rowsCount = Int32(_sParams.GetCount());
+	const Int32 vertsAlongT = Int32(_crvs.GetCount() - 1) * stepsT + 1;
+
+	// Size the bands to about RULEDMESH_BAND_VERTICES vertices.
+	const Int32 bandRows = maxon::Max(Int32(1), RULEDMESH_BAND_VERTICES / vertsAlongT);
+
+	// The cells of a band need the normals of the following row as well.
+	Vector* normalsW = nullptr;
+	if (fillPolygons && normalTag)
+	{
+		_vertexNormals.Resize((bandRows + 1) * vertsAlongT) iferr_return;
+		normalsW = _vertexNormals.GetFirst();
+	}
+
+	// On closed curves the last cells row connects to the end of the S-range, evaluated as an extra
+	// row for the normals only.
+	const Int32 normalRowsCount = closedS ? rowsCount + 1 : rowsCount;
+
+	for (Int32 bandStart = 0; bandStart < rowsCount; bandStart += bandRows)
+	{
+		// Check if a user break has been requested and stop the remaining bands.
+		if (thread && thread->TestBreak())
+			return false;
+
+		const Int32 bandEnd = maxon::Min(bandStart + bandRows, rowsCount);
+		const Int32 bandNormalsEnd = normalsW ? maxon::Min(bandEnd + 1, normalRowsCount) : bandEnd;
+
+		maxon::TimeValue phaseStart = StartPhase(_phaseStats);
+		FillVerticesPosition(verticesW, normalsW, _sParams, bandStart, bandNormalsEnd, stepsT, smooth, flipFirst, flipSecond, paramFirst, paramSecond) iferr_return;
+
+		// The band scratch memory is sized by the first band.
+		const Int64 scratchBytes = bandStart == 0 ? (_crvPoints.GetCount() + (normalsW ? _vertexNormals.GetCount() : 0)) * sizeof(Vector) : 0;
+		EndPhase(_phaseStats, RULEDMESH_PHASE_VERTEXFILL, phaseStart, scratchBytes);
+
+		if (fillPolygons)
+		{
+			phaseStart = StartPhase(_phaseStats);
+			FillPolygonObjectData(polyObj, segmentsS + 1, vertsAlongT, bandStart, bandEnd, closedS, &_sParams, uvwTag, normalTag, normalsW) iferr_return;
+			EndPhase(_phaseStats, RULEDMESH_PHASE_POLYGONFILL, phaseStart);
+		}
+	}
+
+	return true;
+}
+
 maxon::Result<void> RuledMesh::CheckAndSetPhongTag(BaseObject *op, PolygonObject *polyObj)
 {
 	if (!op || !polyObj)
@@ -488,22 +1165,133 @@ maxon::Result<void> RuledMesh::CheckAndSetPhongTag(BaseObject *op, PolygonObject
 	return maxon::OK;
 }
 
-maxon::Result<void> RuledMesh::AllocateSplineHelpers()
+maxon::Result<void> RuledMesh::PrepareAttributeTags(PolygonObject *polyObj, const Bool &generateUVW, const Bool &generateNormals, UVWTag* &uvwTag, NormalTag* &normalTag)
+{
+	uvwTag = nullptr;
+	normalTag = nullptr;
+
+	if (!polyObj)
+		return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+	const Int32 polysCount = polyObj->GetPolygonCount();
+
+	// Check the existing UVW tag: remove it if no more requested or if it doesn't match the polygons.
+	uvwTag = static_cast<UVWTag*>(polyObj->GetTag(Tuvw));
+	if (uvwTag && (!generateUVW || uvwTag->GetDataCount() != polysCount))
+	{
+		polyObj->KillTag(Tuvw);
+		uvwTag = nullptr;
+	}
+
+	if (generateUVW && !uvwTag)
+	{
+		uvwTag = UVWTag::Alloc(polysCount);
+		if (!uvwTag)
+			return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate UVW tag"_s);
+		polyObj->InsertTag(uvwTag);
+	}
+
+	// Check the existing Normal tag in the same way.
+	normalTag = static_cast<NormalTag*>(polyObj->GetTag(Tnormal));
+	if (normalTag && (!generateNormals || normalTag->GetDataCount() != polysCount))
+	{
+		polyObj->KillTag(Tnormal);
+		normalTag = nullptr;
+	}
+
+	if (generateNormals && !normalTag)
+	{
+		normalTag = NormalTag::Alloc(polysCount);
+		if (!normalTag)
+			return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate Normal tag"_s);
+		polyObj->InsertTag(normalTag);
+	}
+
+	return maxon::OK;
+}
+
+PolygonObject* RuledMesh::GetReusableCache(BaseObject* op, HierarchyHelp* hh, const Int32 &stepsS, const Int32 &stepsT, const Bool &closedS)
+{
+	if (!op || !hh)
+		return nullptr;
+
+	// Check the segmentation used to build the cached polygon indexes.
+	if (stepsS != _topologyStepsS || stepsT != _topologyStepsT || closedS != _topologyClosedS)
+		return nullptr;
+
+	BaseObject* cache = op->GetCache(hh);
+	if (!cache || !cache->IsInstanceOf(Opolygon))
+		return nullptr;
+
+	// Check the cached PolygonObject still matches the expected topology.
+	PolygonObject* cachedPolyObj = static_cast<PolygonObject*>(cache);
+	const Int32 vertsAlongS = closedS ? stepsS : stepsS + 1;
+	if (cachedPolyObj->GetPointCount() != vertsAlongS * (stepsT + 1) || cachedPolyObj->GetPolygonCount() != stepsS * stepsT)
+		return nullptr;
+
+	return cachedPolyObj;
+}
+
+maxon::Result<void> RuledMesh::UpdateSplineHelpers(const maxon::BaseArray<BaseObject*> &leaves, const Int32 &paramFirst, const Int32 &paramSecond)
 {
-	// Allocate the SplineLength helper objects.
-	_firstCurveLengthHelper = SplineLengthData::Alloc();
-	if (!_firstCurveLengthHelper)
-		return maxon::NullptrError(MAXON_SOURCE_LOCATION, "First curve helper not allocated"_s);
-	_firstCurveLengthHelper->Init(_firstCrv);
+	iferr_scope;
+
+	const Int crvsCount = _crvs.GetCount();
+	if (leaves.GetCount() < crvsCount)
+		return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+	// Add the slots for the new curve positions: the helpers are only released in Free().
+	while (_crvHelpers.GetCount() < crvsCount)
+		_crvHelpers.Append(CurveHelper{ nullptr, nullptr, nullptr, 0 }) iferr_return;
+
+	for (Int crvIdx = 0; crvIdx < crvsCount; ++crvIdx)
+	{
+		// The SplineLengthHelpers are only needed by the uniform parametrization.
+		const Int32 param = crvIdx == 0 ? paramFirst : paramSecond;
+		if (param != SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM)
+			continue;
+
+		CurveHelper& crvHelper = _crvHelpers[crvIdx];
 
-	_secondCurveLengthHelper = SplineLengthData::Alloc();
-	if (!_secondCurveLengthHelper)
-		return maxon::NullptrError(MAXON_SOURCE_LOCATION, "Second curve helper not allocated"_s);
-	_secondCurveLengthHelper->Init(_secondCrv);
+		// Allocate the SplineLength helper object once.
+		if (!crvHelper.lengthHelper)
+		{
+			crvHelper.lengthHelper = SplineLengthData::Alloc();
+			if (!crvHelper.lengthHelper)
+				return maxon::NullptrError(MAXON_SOURCE_LOCATION, "Curve helper not allocated"_s);
+			crvHelper.leaf = nullptr;
+			crvHelper.dirty = 0;
+		}
+
+		// Rebuild the arc-length data only if the input curve hierarchy has changed or has been reordered.
+		const UInt64 crvDirty = GetHierarchyDirtyChecksum(leaves[crvIdx]);
+		if (crvHelper.leaf != leaves[crvIdx] || crvHelper.dirty != crvDirty)
+		{
+			// The clone in _crvs is released by FreeResources() at the end of the rebuild: initialize the
+			// helper with a copy owned by the helper slot so that it never refers to a released curve.
+			if (crvHelper.spline)
+				SplineObject::Free(crvHelper.spline);
+			crvHelper.leaf = nullptr;
+			crvHelper.spline = static_cast<SplineObject*>(_crvs[crvIdx]->GetClone(COPYFLAGS::NONE, nullptr));
+			if (!crvHelper.spline)
+				return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Curve copy not allocated"_s);
+			if (!crvHelper.lengthHelper->Init(crvHelper.spline))
+				return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Curve helper not initialized"_s);
+			crvHelper.leaf = leaves[crvIdx];
+			crvHelper.dirty = crvDirty;
+		}
+	}
 
 	return maxon::OK;
 }
 
+Vector RuledMesh::GetPointOnInputCurve(const Int &crvIdx, const Float &sParam, const Bool &flipFirst, const Bool &flipSecond, const Int32 &paramFirst, const Int32 &paramSecond) const
+{
+	// The first curve has its own settings, all the others share the second curve ones.
+	const Bool isFirst = crvIdx == 0;
+	return GetPointOnCurve(_crvs[crvIdx], _crvHelpers[crvIdx].lengthHelper, _crvMtxs[crvIdx], sParam, isFirst ? flipFirst : flipSecond, isFirst ? paramFirst : paramSecond);
+}
+
 Bool RegisterRuledMesh()
 {
 	String registeredName = GeLoadString(IDS_OBJECTDATA_RULEDMESH);
@@ -0,0 +1,239 @@
+#include "c4d_basedocument.h"
+#include "c4d_baseobject.h"
+#include "c4d_file.h"
+
+#include "maxon/timevalue.h"
+
+#include "objectdata_ruledmesh.h"
+#include "ruledmesh_benchmark.h"
+
+// Local resources
+#include "oruledmesh.h"
+
+#ifdef RULEDMESH_BENCHMARK
+
+/// Generator whose rebuilds are measured and the statistics they fill, see SetRuledMeshPhaseStats().
+static const BaseObject* g_phaseStatsGenerator = nullptr;
+static RuledMeshPhaseStats* g_phaseStats = nullptr;
+
+void SetRuledMeshPhaseStats(const BaseObject* generator, RuledMeshPhaseStats* stats)
+{
+	g_phaseStatsGenerator = stats ? generator : nullptr;
+	g_phaseStats = stats;
+}
+
+RuledMeshPhaseStats* GetRuledMeshPhaseStats(const BaseObject* generator)
+{
+	return (generator && generator == g_phaseStatsGenerator) ? g_phaseStats : nullptr;
+}
+
+/// Number of measured rebuilds for each configuration, the median time is reported.
+static const Int32 BENCHMARK_REPETITIONS = 5;
+
+/// Names of the measured phases as written in the CSV file.
+static const Char* const BENCHMARK_PHASE_NAMES[RULEDMESH_PHASE_COUNT] =
+{
+	"hierarchy_clone",
+	"spline_helpers",
+	"mesh_allocation",
+	"vertex_fill",
+	"polygon_fill",
+	"phong_tag"
+};
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to allocate a procedural spline: a sine wave along the X-axis placed at
+/// the given height.
+/// @brief Global helper function to allocate a procedural spline.
+/// @param[in] pointsCount				The number of control points.
+/// @param[in] height							The position of the wave along the Y-axis.
+/// @param[in] amplitude					The amplitude of the wave along the Z-axis.
+/// @param[in] frequency					The number of periods of the wave.
+/// @return												The allocated SplineObject, nullptr if the allocation fails. @callerOwnsPointed{spline object}.
+//------------------------------------------------------------------------------------------------
+static SplineObject* AllocWaveSpline(const Int32 pointsCount, const Float height, const Float amplitude, const Float frequency)
+{
+	SplineObject* spline = SplineObject::Alloc(pointsCount, SPLINETYPE::BSPLINE);
+	if (!spline)
+		return nullptr;
+
+	Vector* pointsW = spline->GetPointW();
+	if (!pointsW)
+	{
+		SplineObject::Free(spline);
+		return nullptr;
+	}
+
+	for (Int32 i = 0; i < pointsCount; ++i)
+	{
+		const Float x = Float(i) / Float(pointsCount - 1);
+		pointsW[i] = Vector(x * 1000.0 - 500.0, height, maxon::Sin(x * frequency * maxon::PI2) * amplitude);
+	}
+
+	spline->Message(MSG_UPDATE);
+	return spline;
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to return the median of a small set of values. The values are sorted.
+/// @brief Global helper function to return the median of a small set of values.
+/// @param[in,out] values					The pointer to the values array. @callerOwnsPointed{values array}.
+/// @param[in] count							The number of values.
+/// @return												The median value.
+//------------------------------------------------------------------------------------------------
+static Float Median(Float* values, const Int32 count)
+{
+	for (Int32 i = 1; i < count; ++i)
+	{
+		const Float value = values[i];
+		Int32 j = i;
+		for (; j > 0 && values[j - 1] > value; --j)
+			values[j] = values[j - 1];
+		values[j] = value;
+	}
+
+	return values[count / 2];
+}
+
+//------------------------------------------------------------------------------------------------
+/// Global helper function to write a line in the CSV file.
+/// @brief Global helper function to write a line in the CSV file.
+/// @param[in] file								The reference to the opened BaseFile instance.
+/// @param[in] line								The line to write, including the line feed.
+/// @return												maxon::OK if operation completes successfully, maxon::Result otherwise.
+//------------------------------------------------------------------------------------------------
+static maxon::Result<void> WriteLine(BaseFile& file, const String& line)
+{
+	iferr_scope;
+
+	// The C string is null-terminated.
+	const maxon::BaseArray<Char> cString = line.GetCString() iferr_return;
+	if (!file.WriteBytes(cString.GetFirst(), cString.GetCount() - 1))
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to write the benchmark output file"_s);
+
+	return maxon::OK;
+}
+
+maxon::Result<void> RunRuledMeshBenchmark(const Filename& csvFile)
+{
+	iferr_scope;
+
+	AutoAlloc<BaseDocument> doc;
+	if (!doc)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate the benchmark document"_s);
+
+	// The generator is kept out of the document: every measured rebuild works on a fresh copy so that
+	// no cached topology is reused between repetitions.
+	AutoAlloc<BaseObject> ruledMesh(ID_DEVKITCHEN_OBJECTDATA_RULEDMESH);
+	if (!ruledMesh)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate the RuledMesh generator"_s);
+
+	SplineObject* firstCrv = AllocWaveSpline(64, 0.0, 100.0, 2.0);
+	if (!firstCrv)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate the first curve"_s);
+	firstCrv->InsertUnder(ruledMesh);
+
+	SplineObject* secondCrv = AllocWaveSpline(64, 300.0, 50.0, 5.0);
+	if (!secondCrv)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to allocate the second curve"_s);
+	secondCrv->InsertUnderLast(ruledMesh);
+
+	BaseContainer* bcPtr = ruledMesh->GetDataInstance();
+	if (!bcPtr)
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to access the RuledMesh parameters"_s);
+
+	AutoAlloc<BaseFile> file;
+	if (!file || !file->Open(csvFile, FILEOPEN::WRITE, FILEDIALOG::NONE))
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to open the benchmark output file"_s);
+
+	WriteLine(*file, "s_steps,t_steps,flip_first,flip_second,param,build,phase,time_ms,estimated_bytes\n"_s) iferr_return;
+
+	static const Int32 stepsValues[] = { 16, 64, 256, 1024 };
+	static const Int32 paramValues[] = { SDK_EXAMPLE_RULEDMESH_PARAM_NATURAL, SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM };
+
+	// Collect the statistics of the rebuilds of the measured generator, and stop collecting them
+	// whatever the exit path.
+	RuledMeshPhaseStats stats;
+	finally
+	{
+		SetRuledMeshPhaseStats(nullptr, nullptr);
+	};
+
+	for (const Int32 stepsS : stepsValues)
+	{
+		for (const Int32 stepsT : stepsValues)
+		{
+			for (Int32 flips = 0; flips < 4; ++flips)
+			{
+				for (const Int32 param : paramValues)
+				{
+					const Bool flipFirst = (flips & 1) != 0;
+					const Bool flipSecond = (flips & 2) != 0;
+
+					bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_S_STEPS, stepsS);
+					bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_T_STEPS, stepsT);
+					bcPtr->SetBool(SDK_EXAMPLE_RULEDMESH_FLIP_FIRST, flipFirst);
+					bcPtr->SetBool(SDK_EXAMPLE_RULEDMESH_FLIP_SECOND, flipSecond);
+					bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_PARAM_FIRST, param);
+					bcPtr->SetInt32(SDK_EXAMPLE_RULEDMESH_PARAM_SECOND, param);
+
+					// Measure the full rebuild of a fresh generator and the update of its vertices after
+					// a change of the first curve.
+					Float fullTimes[RULEDMESH_PHASE_COUNT][BENCHMARK_REPETITIONS];
+					Float updateTimes[RULEDMESH_PHASE_COUNT][BENCHMARK_REPETITIONS];
+					Int64 fullBytes[RULEDMESH_PHASE_COUNT] = {};
+					Int64 updateBytes[RULEDMESH_PHASE_COUNT] = {};
+
+					for (Int32 rep = 0; rep < BENCHMARK_REPETITIONS; ++rep)
+					{
+						BaseObject* generator = static_cast<BaseObject*>(ruledMesh->GetClone(COPYFLAGS::NONE, nullptr));
+						if (!generator)
+							return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION, "Failed to clone the RuledMesh generator"_s);
+						doc->InsertObject(generator, nullptr, nullptr);
+						SetRuledMeshPhaseStats(generator, &stats);
+
+						stats.Reset();
+						doc->ExecutePasses(nullptr, false, false, true, BUILDFLAGS::NONE);
+						for (Int32 phase = 0; phase < RULEDMESH_PHASE_COUNT; ++phase)
+						{
+							fullTimes[phase][rep] = stats.time[phase].GetMilliseconds();
+							fullBytes[phase] = maxon::Max(fullBytes[phase], stats.estimatedBytes[phase]);
+						}
+
+						SplineObject* generatorCrv = static_cast<SplineObject*>(generator->GetDown());
+						Vector* pointsW = generatorCrv ? generatorCrv->GetPointW() : nullptr;
+						if (pointsW)
+						{
+							pointsW[0].y += 1.0;
+							generatorCrv->Message(MSG_UPDATE);
+						}
+
+						stats.Reset();
+						doc->ExecutePasses(nullptr, false, false, true, BUILDFLAGS::NONE);
+						for (Int32 phase = 0; phase < RULEDMESH_PHASE_COUNT; ++phase)
+						{
+							updateTimes[phase][rep] = stats.time[phase].GetMilliseconds();
+							updateBytes[phase] = maxon::Max(updateBytes[phase], stats.estimatedBytes[phase]);
+						}
+
+						SetRuledMeshPhaseStats(nullptr, nullptr);
+						generator->Remove();
+						BaseObject::Free(generator);
+					}
+
+					for (Int32 phase = 0; phase < RULEDMESH_PHASE_COUNT; ++phase)
+					{
+						const String config = FormatString("@,@,@,@,@", stepsS, stepsT, flipFirst ? 1 : 0, flipSecond ? 1 : 0, param == SDK_EXAMPLE_RULEDMESH_PARAM_UNIFORM ? "uniform"_s : "natural"_s);
+						WriteLine(*file, FormatString("@,full,@,@,@\n", config, BENCHMARK_PHASE_NAMES[phase], Median(fullTimes[phase], BENCHMARK_REPETITIONS), fullBytes[phase])) iferr_return;
+						WriteLine(*file, FormatString("@,update,@,@,@\n", config, BENCHMARK_PHASE_NAMES[phase], Median(updateTimes[phase], BENCHMARK_REPETITIONS), updateBytes[phase])) iferr_return;
+					}
+				}
+			}
+		}
+	}
+
+	file->Close();
+	return maxon::OK;
+}
+
+#endif // RULEDMESH_BENCHMARK
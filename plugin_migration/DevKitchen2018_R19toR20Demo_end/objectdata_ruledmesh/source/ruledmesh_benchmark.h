@@ -0,0 +1,56 @@
+#ifndef _RULEDMESH_BENCHMARK__
+#define _RULEDMESH_BENCHMARK__
+
+#include "maxon/timevalue.h"
+
+// The RuledMesh phase statistics and the benchmark are compiled in debug builds; define RULEDMESH_BENCHMARK
+// to compile them in release builds too. Otherwise the generator doesn't measure its phases.
+#if defined(MAXON_TARGET_DEBUG) && !defined(RULEDMESH_BENCHMARK)
+	#define RULEDMESH_BENCHMARK
+#endif
+
+/**The phases of the RuledMesh generation measured by RuledMeshPhaseStats.*/
+enum RULEDMESH_PHASE
+{
+	RULEDMESH_PHASE_HIERARCHYCLONE = 0,
+	RULEDMESH_PHASE_SPLINEHELPERS,
+	RULEDMESH_PHASE_MESHALLOCATION,
+	RULEDMESH_PHASE_VERTEXFILL,
+	RULEDMESH_PHASE_POLYGONFILL,
+	RULEDMESH_PHASE_PHONGTAG,
+	RULEDMESH_PHASE_COUNT
+};
+
+/**Time spent and memory allocated by the RuledMesh generation in each phase. The memory is an estimate, not a measured peak: the size of the buffers allocated by the phase, as computed by the generator from the element counts.*/
+struct RuledMeshPhaseStats
+{
+	maxon::TimeValue time[RULEDMESH_PHASE_COUNT];
+	Int64 estimatedBytes[RULEDMESH_PHASE_COUNT];
+
+	void Reset()
+	{
+		for (Int32 i = 0; i < RULEDMESH_PHASE_COUNT; ++i)
+		{
+			time[i] = maxon::TimeValue();
+			estimatedBytes[i] = 0;
+		}
+	}
+};
+
+#ifdef RULEDMESH_BENCHMARK
+
+/**Command line argument, followed by the path of the CSV file to write, running the RuledMesh benchmark.*/
+static const Char* const RULEDMESH_BENCHMARK_ARG = "-ruledmesh_benchmark";
+
+/**Sets the statistics filled by the rebuilds of the given RuledMesh generator, nullptr to stop collecting them. Only the rebuilds of that generator write the statistics. Must be called from the main thread while the document of the generator is not evaluated.*/
+void SetRuledMeshPhaseStats(const BaseObject* generator, RuledMeshPhaseStats* stats);
+
+/**Returns the statistics to fill for the given RuledMesh generator, nullptr if they are not collected.*/
+RuledMeshPhaseStats* GetRuledMeshPhaseStats(const BaseObject* generator);
+
+/**Builds a document with two procedural splines under a RuledMesh generator and measures the generation sweeping S/T-steps, flip flags and parametrization. The time of each phase and an estimate of the buffers it allocates, computed from the element counts rather than measured, are written as CSV in the given file.*/
+maxon::Result<void> RunRuledMeshBenchmark(const Filename& csvFile);
+
+#endif // RULEDMESH_BENCHMARK
+
+#endif // _RULEDMESH_BENCHMARK__
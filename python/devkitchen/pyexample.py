@@ -14,3 +14,42 @@ class ExampleInterface(maxon.Data):
                                                                             ])
     def CreateObject():
         pass
+
+    @staticmethod
+    @MAXON_STATICMETHOD("devkitchen.python.exampleinterface.CreateObjects", annotations=[
+                                                                            None, # object type
+                                                                            None, # count
+                                                                            None, # matrices, empty or one maxon.Matrix per object
+                                                                            Ptr[BaseObject], # parent, owns the created objects
+                                                                            Result[maxon.BaseArray] # maxon.BaseArray of the created objects
+                                                                            ])
+    def CreateObjects():
+        pass
+
+    # The methods below return all their results in a single maxon.BaseArray, in one call.
+    # Each element access of the array still goes through the maxon binding.
+
+    @staticmethod
+    @MAXON_STATICMETHOD("devkitchen.python.exampleinterface.SampleFieldObject", annotations=[
+                                                                            Ptr[BaseObject], # field object
+                                                                            None, # positions, maxon.BaseArray of maxon.Vector
+                                                                            Result[maxon.BaseArray] # sampled values, maxon.BaseArray of maxon.Float
+                                                                            ])
+    def SampleFieldObject():
+        pass
+
+    @staticmethod
+    @MAXON_STATICMETHOD("devkitchen.python.exampleinterface.GetVolumeActiveVoxels", annotations=[
+                                                                            Ptr[BaseObject], # volume object or volume builder
+                                                                            Result[maxon.BaseArray] # maxon.BaseArray of maxon.Vector4d, position in x, y, z and value in w
+                                                                            ])
+    def GetVolumeActiveVoxels():
+        pass
+
+    @staticmethod
+    @MAXON_STATICMETHOD("devkitchen.python.exampleinterface.GetInstanceMatrices", annotations=[
+                                                                            Ptr[BaseObject], # instance object
+                                                                            Result[maxon.BaseArray] # maxon.BaseArray of maxon.Matrix
+                                                                            ])
+    def GetInstanceMatrices():
+        pass
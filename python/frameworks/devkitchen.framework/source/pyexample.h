@@ -18,6 +18,22 @@ class ExampleInterface
 
 public:
 	static MAXON_METHOD Result<BaseObject*>CreateObject(OBJECTTYPE oType);
+
+	// Creates count objects in one call. matrices is either empty or holds one matrix per object.
+	// The objects are inserted under parent in order and owned by it, parent must not be nullptr.
+	static MAXON_METHOD Result<BaseArray<BaseObject*>>CreateObjects(OBJECTTYPE oType, Int count, const BaseArray<Matrix>& matrices, BaseObject* parent);
+
+	// The methods below return all their results in a single array, so Python receives the data in one call instead of one call per element.
+	// Reading the elements of the array from Python still goes through the maxon binding for each element.
+
+	// Samples the values of a field object at the given world positions.
+	static MAXON_METHOD Result<BaseArray<Float>>SampleFieldObject(BaseObject* fieldObject, const BaseArray<Vector>& positions);
+
+	// Returns the active voxels of a volume object or volume builder: world position in x, y, z and value in w.
+	static MAXON_METHOD Result<BaseArray<Vector4d>>GetVolumeActiveVoxels(BaseObject* volumeObject);
+
+	// Returns the multi-instance matrices of an instance object.
+	static MAXON_METHOD Result<BaseArray<Matrix>>GetInstanceMatrices(BaseObject* instanceObject);
 };
 
 #include "pyexample1.hxx"
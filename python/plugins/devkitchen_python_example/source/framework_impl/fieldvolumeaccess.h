@@ -0,0 +1,57 @@
+#ifndef DEVKITCHEN_FIELDVOLUMEACCESS_H__
+#define DEVKITCHEN_FIELDVOLUMEACCESS_H__
+
+#include "c4d.h"
+#include "c4d_fielddata.h"
+#include "maxon/volume.h"
+#include "maxon/volumeiterators.h"
+
+//----------------------------------------------------------------------------------------
+/// Samples a field object for the given points into the given output block. The field is
+/// initialized before and freed after sampling, also if sampling fails.
+/// @param[in] field							The field object to sample.
+/// @param[in] points							The points to sample.
+/// @param[in] info								The sampling information.
+/// @param[out] block							The output block receiving the sampled data.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+inline maxon::Result<void> SampleFieldObjectValues(FieldObject& field, const FieldInput& points, const FieldInfo& info, FieldOutputBlock& block)
+{
+	iferr_scope;
+
+	FieldShared shared;
+	field.InitSampling(info, shared) iferr_return;
+	const maxon::Result<void> sampled = field.Sample(points, block, info);
+	field.FreeSampling(info, shared);
+
+	return sampled;
+}
+
+//----------------------------------------------------------------------------------------
+/// Calls a function for each active voxel of a Float32 volume, with the voxel position in world space.
+/// @param[in] volume							The volume to iterate.
+/// @param[in] fn									Called as fn(const Vector& position, Float32 value), returning maxon::Result<void>.
+///																An error stops the iteration and is returned.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+template <typename FN>
+inline maxon::Result<void> ForEachActiveVoxel(const maxon::VolumeRef& volume, FN&& fn)
+{
+	iferr_scope;
+
+	maxon::GridIteratorRef<Float32, maxon::ITERATORTYPE::ON> iterator = maxon::GridIteratorRef<Float32, maxon::ITERATORTYPE::ON>::Create() iferr_return;
+	iterator.Init(volume) iferr_return;
+
+	const maxon::Matrix transform = volume.GetGridTransform();
+
+	for (; iterator.IsNotAtEnd(); iterator.StepNext())
+	{
+		const maxon::IntVector32 coord = iterator.GetCoords();
+		const Vector						 pos = transform * Vector(Float(coord.x), Float(coord.y), Float(coord.z));
+		fn(pos, iterator.GetValue()) iferr_return;
+	}
+
+	return maxon::OK;
+}
+
+#endif
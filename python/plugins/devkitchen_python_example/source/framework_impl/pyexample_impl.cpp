@@ -1,7 +1,11 @@
 #include "c4d.h"
+#include "c4d_fielddata.h"
+#include "lib_volumeobject.h"
+#include "lib_instanceobject.h"
 
 // MAXON API header files
 #include "pyexample.h"
+#include "fieldvolumeaccess.h"
 #include "maxon/interfacebase.h"
 #include "maxon/configuration.h"
 
@@ -21,6 +25,112 @@ public:
 
 		return obj.Release();
 	}
+
+	static Result<BaseArray<BaseObject*>>CreateObjects(OBJECTTYPE oType, Int count, const BaseArray<Matrix>& matrices, BaseObject* parent)
+	{
+		iferr_scope;
+		// the parent owns the objects, so nothing is left without an owner on the Python side
+		if (parent == nullptr || count < 0 || (matrices.IsEmpty() == false && matrices.GetCount() != count))
+			return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+		BaseArray<BaseObject*> objects;
+		objects.EnsureCapacity(count) iferr_return;
+
+		// free the objects created so far if the batch can't be completed
+		Bool completed = false;
+		finally
+		{
+			if (completed == false)
+			{
+				for (BaseObject* obj : objects)
+					BaseObject::Free(obj);
+			}
+		};
+
+		for (Int i = 0; i < count; ++i)
+		{
+			BaseObject* const obj = BaseObject::Alloc(Int32(oType));
+			if (obj == nullptr)
+				return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+			objects.Append(obj) iferr_return;
+
+			if (matrices.IsEmpty() == false)
+				obj->SetMl(matrices[i]);
+		}
+
+		// insert as first child in reverse order, this keeps the order without walking the children
+		for (Int i = count - 1; i >= 0; --i)
+			objects[i]->InsertUnder(parent);
+
+		completed = true;
+		return std::move(objects);
+	}
+
+	static Result<BaseArray<Float>>SampleFieldObject(BaseObject* fieldObject, const BaseArray<Vector>& positions)
+	{
+		iferr_scope;
+		if (fieldObject == nullptr || fieldObject->IsInstanceOf(Ofield) == false)
+			return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+		FieldObject* const field = static_cast<FieldObject*>(fieldObject);
+
+		// fake the caller since the field is not sampled by the object owning it
+		AutoAlloc<BaseList2D> caller{Onull};
+		if (caller == nullptr)
+			return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+		const Int count = positions.GetCount();
+		FieldInput points(positions.GetFirst(), count, Matrix());
+
+		FieldOutput results;
+		results.Resize(count, FIELDSAMPLE_FLAG::VALUE) iferr_return;
+		FieldOutputBlock block = results.GetBlock();
+
+		const FieldInfo info = FieldInfo::Create(caller, points, FIELDSAMPLE_FLAG::VALUE) iferr_return;
+		SampleFieldObjectValues(*field, points, info, block) iferr_return;
+
+		// hand over the sampled values without copying them
+		BaseArray<Float> values = std::move(results._value);
+		return std::move(values);
+	}
+
+	static Result<BaseArray<Vector4d>>GetVolumeActiveVoxels(BaseObject* volumeObject)
+	{
+		iferr_scope;
+		if (volumeObject == nullptr)
+			return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+		// a volume builder stores its volume object in its cache
+		BaseObject* const volumeSource = volumeObject->IsInstanceOf(Ovolumebuilder) ? volumeObject->GetCache() : volumeObject;
+		if (volumeSource == nullptr || volumeSource->IsInstanceOf(Ovolume) == false)
+			return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+		const VolumeRef volume = static_cast<VolumeObject*>(volumeSource)->GetVolume();
+
+		BaseArray<Vector4d> voxels;
+		ForEachActiveVoxel(volume,
+			[&voxels](const Vector& pos, Float32 value) -> Result<void>
+			{
+				iferr_scope;
+				voxels.Append(Vector4d(pos.x, pos.y, pos.z, Float(value))) iferr_return;
+				return OK;
+			}) iferr_return;
+
+		return std::move(voxels);
+	}
+
+	static Result<BaseArray<Matrix>>GetInstanceMatrices(BaseObject* instanceObject)
+	{
+		iferr_scope;
+		if (instanceObject == nullptr || instanceObject->IsInstanceOf(Oinstance) == false)
+			return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION);
+
+		// a single block copy of the stored matrices
+		BaseArray<Matrix> matrices;
+		matrices.CopyFrom(static_cast<InstanceObject*>(instanceObject)->GetInstanceMatrices()) iferr_return;
+		return std::move(matrices);
+	}
 };
 MAXON_IMPLEMENTATION_REGISTER(ExampleImpl);
 
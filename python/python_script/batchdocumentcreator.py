@@ -0,0 +1,104 @@
+# Builds many documents from a spec file then saves them as c4d files.
+# Usage: c4dpy batchdocumentcreator.py -spec variants.json [-output folder] [-workers 4]
+#
+# The spec file is a JSON file listing the documents to build:
+# {"documents": [{"name": "variant_0", "objects": [{"type": "CUBE", "count": 1000, "spacing": 250.0}]}]}
+#
+# With more than one worker, the script starts itself again in worker processes. Each worker builds
+# every n-th document of the spec, so the documents are built in parallel and each process pays the
+# application startup once for many documents.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+import c4d
+import maxon
+from c4d import documents
+
+import devkitchen
+
+def build_document(spec):
+    # Creates a document
+    doc = documents.BaseDocument()
+
+    for entry in spec.get('objects', []):
+        typeName = entry.get('type', 'CUBE').upper()
+        count = int(entry.get('count', 1))
+        spacing = float(entry.get('spacing', 250.0))
+
+        # Places the objects in a row, the matrices are applied by CreateObjects
+        matrices = maxon.BaseArray(maxon.Matrix)
+        matrices.Resize(count)
+        for index in range(count):
+            matrix = maxon.Matrix()
+            matrix.off = maxon.Vector(index * spacing, 0.0, 0.0)
+            matrices[index] = matrix
+
+        # Creates all the objects of the entry in a single call, under a parent null
+        parent = c4d.BaseObject(c4d.Onull)
+        parent.SetName('{} x{}'.format(typeName.lower(), count))
+        devkitchen.ExampleInterface.CreateObjects(getattr(maxon.OBJECTTYPE, typeName), count, matrices, parent)
+
+        doc.InsertObject(parent)
+
+    return doc
+
+def run_worker(specs, output, worker, workers):
+    failed = 0
+    for spec in specs[worker::workers]:
+        doc = build_document(spec)
+
+        # Saves the document
+        name = os.path.join(output, '{}.c4d'.format(spec['name']))
+        if documents.SaveDocument(doc, name, c4d.SAVEDOCUMENTFLAGS_0, c4d.FORMAT_C4DEXPORT):
+            print('Succesfully saved document to \'{}\''.format(name))
+        else:
+            print('Failed to save document to \'{}\''.format(name))
+            failed += 1
+
+        # The document was never inserted, releasing the Python reference frees it
+        doc = None
+
+    return failed
+
+def run_workers(args):
+    # Starts one process per worker with the same spec, then waits for all of them
+    processes = []
+    for worker in range(args.workers):
+        command = [sys.executable, os.path.abspath(__file__),
+                   '-spec', args.spec, '-output', args.output,
+                   '-workers', str(args.workers), '-worker', str(worker)]
+        processes.append(subprocess.Popen(command))
+
+    return sum(1 for process in processes if process.wait() != 0)
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-spec', required=True, help='JSON file listing the documents to build')
+    parser.add_argument('-output', help='Folder of the saved documents, the folder of the spec file by default')
+    parser.add_argument('-workers', type=int, default=1, help='Number of worker processes')
+    parser.add_argument('-worker', type=int, default=-1, help='Index of this worker process, set by the script itself')
+    args = parser.parse_args()
+
+    args.spec = os.path.abspath(args.spec)
+    if args.output is None:
+        args.output = os.path.dirname(args.spec)
+    if not os.path.isdir(args.output):
+        os.makedirs(args.output)
+    args.workers = max(1, args.workers)
+
+    if args.workers > 1 and args.worker < 0:
+        failed = run_workers(args)
+    else:
+        with open(args.spec) as specFile:
+            specs = json.load(specFile)['documents']
+        failed = run_worker(specs, args.output, max(0, args.worker), args.workers)
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__=='__main__':
+    main()
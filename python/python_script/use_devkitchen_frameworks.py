@@ -9,6 +9,11 @@ def main():
     obj = devkitchen.ExampleInterface.CreateObject(objType)
     # obj = devkitchen.ExampleInterface.CreateObject(maxon.OBJECTTYPE.CUBE)
 
+    # Many objects are created in a single call, inserted under a parent:
+    # parent = c4d.BaseObject(c4d.Onull)
+    # devkitchen.ExampleInterface.CreateObjects(objType, 1000, maxon.BaseArray(maxon.Matrix), parent)
+    # doc.InsertObject(parent)
+
     doc.InsertObject(obj)
     c4d.EventAdd()
 
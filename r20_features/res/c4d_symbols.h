@@ -13,6 +13,12 @@ enum
 	IDS_NEXTNEIGHBOR_LAYER,
 	IDS_CREATE_MULTIINSTANCE_COMMAND,
 	IDS_READ_MULTIINSTACE_COMMAND,
+	IDS_CREATE_FIELD_MULTIINSTANCE_COMMAND,
+	IDS_DUMP_PROFILING_COMMAND,
+	IDS_EXPORT_VOLUME_COMMAND,
+	IDS_IMPORT_VOLUME_COMMAND,
+	IDS_FIELD_SAMPLE_CACHE_COMMAND,
+	IDS_FIELD_MULTIINSTANCE_OBJECT,
 	_DUMMY_ELEMENT_
 };
 
@@ -0,0 +1,11 @@
+#ifndef OFIELDMULTIINSTANCE_H__
+#define OFIELDMULTIINSTANCE_H__
+
+enum
+{
+	FIELDMULTIINSTANCE_REFERENCE = 1000,
+	FIELDMULTIINSTANCE_DIMENSION,
+	FIELDMULTIINSTANCE_SPACING,
+	FIELDMULTIINSTANCE_FIELDS
+};
+#endif	// OFIELDMULTIINSTANCE_H__
@@ -0,0 +1,13 @@
+CONTAINER Ofieldmultiinstance
+{
+	NAME Ofieldmultiinstance;
+	INCLUDE Obase;
+
+	GROUP ID_OBJECTPROPERTIES
+	{
+		LINK FIELDMULTIINSTANCE_REFERENCE { ACCEPT { Obase; } }
+		LONG FIELDMULTIINSTANCE_DIMENSION { MIN 1; MAX 1000; }
+		REAL FIELDMULTIINSTANCE_SPACING { UNIT METER; STEP 1.0; MIN 0.0; }
+		FIELDLIST FIELDMULTIINSTANCE_FIELDS { SCALE_V; }
+	}
+}
\ No newline at end of file
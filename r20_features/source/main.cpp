@@ -3,13 +3,29 @@
 #include "c4d_resource.h"
 
 #include "r20_features.h"
+#include "profiling.h"
+
+//----------------------------------------------------------------------------------------
+/// Calls a registration function and records its duration as a startup phase.
+/// @param[in] name								Name of the phase, must be a string literal.
+/// @param[in] registerFunc				The registration function.
+//----------------------------------------------------------------------------------------
+static void TimeRegistration(const Char* name, void (*registerFunc)())
+{
+	const maxon::TimeValue start = maxon::TimeValue::GetTime();
+	registerFunc();
+	RecordStartupPhase(name, maxon::TimeValue::GetTime() - start);
+}
 
 ::Bool PluginStart()
 {
 	// R20 features examples
-	RegisterMographFieldsExamples();
-	RegisterVolumeExamples();
-	RegisterMultiInstancesExamples();
+	// registration only passes names and allocates the empty plugin classes, descriptions are loaded
+	// by Cinema 4D on first use and all other data is built when a command or a field is executed
+	TimeRegistration("RegisterMographFieldsExamples", RegisterMographFieldsExamples);
+	TimeRegistration("RegisterVolumeExamples", RegisterVolumeExamples);
+	TimeRegistration("RegisterMultiInstancesExamples", RegisterMultiInstancesExamples);
+	TimeRegistration("RegisterProfilingCommand", RegisterProfilingCommand);
 
 	return true;
 }
@@ -26,8 +42,43 @@ void PluginEnd()
 		case C4DPL_INIT_SYS:
 		{
 			// load resources defined in the the optional "res" folder
+			const maxon::TimeValue start = maxon::TimeValue::GetTime();
 			if (!g_resource.Init())
 				return false;
+			RecordStartupPhase("Resource initialization", maxon::TimeValue::GetTime() - start);
+
+			return true;
+		}
+
+		case C4DPL_COMMANDLINEARGS:
+		{
+			// report the startup and run the benchmark when requested, consume their arguments
+			C4DPL_CommandLineArgs* const args = static_cast<C4DPL_CommandLineArgs*>(data);
+			if (args == nullptr)
+				return false;
+
+			for (Int32 i = 0; i < args->argc; ++i)
+			{
+				if (args->argv[i] != nullptr && strcmp(args->argv[i], R20FEATURES_STARTUP_REPORT_ARG) == 0)
+				{
+					args->argv[i] = nullptr;
+					ReportStartupPhases();
+				}
+			}
+
+			for (Int32 i = 0; i < args->argc - 1; ++i)
+			{
+				if (args->argv[i] == nullptr || strcmp(args->argv[i], R20FEATURES_BENCHMARK_ARG) != 0 || args->argv[i + 1] == nullptr)
+					continue;
+
+				const Filename csvFile(String(args->argv[i + 1]));
+				args->argv[i] = nullptr;
+				args->argv[i + 1] = nullptr;
+
+				iferr (RunR20FeaturesBenchmark(csvFile))
+					DiagnosticOutput("Benchmark failed: @", err);
+				break;
+			}
 
 			return true;
 		}
@@ -0,0 +1,323 @@
+// local header files and resources
+#include "r20_features.h"
+#include "fieldcache.h"
+#include "fieldvolumeaccess.h"
+
+// classic API header files
+#include "c4d_general.h"
+#include "c4d_basedocument.h"
+#include "c4d_file.h"
+#include "c4d_fielddata.h"
+#include "customgui_field.h"
+
+// parameter IDs
+#include "ofalloff_panel.h"
+
+// MAXON API header files
+#include "maxon/timevalue.h"
+#include "maxon/sort.h"
+
+/// Number of measured runs of each benchmark case.
+static const Int BENCHMARK_REPETITIONS = 20;
+
+/// Plain effector object type, the field list of the bundled scenes is stored in such an effector.
+static const Int32 BENCHMARK_PLAIN_EFFECTOR = 1021337;
+
+//----------------------------------------------------------------------------------------
+/// Counts the objects of a hierarchy.
+/// @param[in] object							The first object of the hierarchy, can be nullptr.
+/// @return												The number of objects including all children and following siblings.
+//----------------------------------------------------------------------------------------
+static Int CountObjects(BaseObject* object)
+{
+	Int count = 0;
+	for (; object != nullptr; object = object->GetNext())
+		count += 1 + CountObjects(object->GetDown());
+
+	return count;
+}
+
+//----------------------------------------------------------------------------------------
+/// Searches a hierarchy for the first object of the given type.
+/// @param[in] object							The first object of the hierarchy, can be nullptr.
+/// @param[in] type								The object type to search.
+/// @return												The found object or nullptr.
+//----------------------------------------------------------------------------------------
+static BaseObject* FindObject(BaseObject* object, Int32 type)
+{
+	for (; object != nullptr; object = object->GetNext())
+	{
+		if (object->IsInstanceOf(type))
+			return object;
+
+		BaseObject* const child = FindObject(object->GetDown(), type);
+		if (child != nullptr)
+			return child;
+	}
+
+	return nullptr;
+}
+
+//----------------------------------------------------------------------------------------
+/// Loads one of the bundled scenes and evaluates it.
+/// @param[in] sceneName					The file name of the scene in the plugin folder.
+/// @return												The loaded document. @callerOwnsPointed{document}.
+//----------------------------------------------------------------------------------------
+static maxon::Result<BaseDocument*> LoadScene(const String& sceneName)
+{
+	const Filename scenePath = GeGetPluginPath() + Filename(sceneName);
+
+	BaseDocument* const doc = LoadDocument(scenePath, SCENEFILTER::OBJECTS | SCENEFILTER::MATERIALS, nullptr);
+	if (doc == nullptr)
+		return maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(scenePath, MAXONCONVERTMODE::NONE), "Failed to load benchmark scene."_s);
+
+	doc->ExecutePasses(nullptr, true, true, true, BUILDFLAGS::NONE);
+
+	return doc;
+}
+
+//----------------------------------------------------------------------------------------
+/// Writes the statistics of a benchmark case as a CSV line.
+/// @param[in] file								The output file.
+/// @param[in] caseName						The name of the benchmark case.
+/// @param[in] sceneName					The file name of the used scene.
+/// @param[in] size								The input size of the case.
+/// @param[in,out] times					The measured times in milliseconds, sorted by this function.
+/// @param[in] createdObjects			The number of objects created by each run.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+static maxon::Result<void> WriteResult(BaseFile& file, const String& caseName, const String& sceneName, Int size, maxon::BaseArray<Float>& times, Int createdObjects)
+{
+	iferr_scope;
+
+	if (times.IsEmpty())
+		return maxon::OK;
+
+	maxon::SimpleSort<> sort;
+	sort.Sort(times);
+
+	const Int		count	= times.GetCount();
+	const Float median = times[count / 2];
+	const Float p95		= times[maxon::Max(Int(0), (count * 95 + 99) / 100 - 1)];
+
+	const String line = FormatString("@,@,@,@,@,@\n", caseName, sceneName, size, median, p95, createdObjects);
+
+	// the C string is null-terminated
+	const maxon::BaseArray<Char> cString = line.GetCString() iferr_return;
+	if (!file.WriteBytes(cString.GetFirst(), cString.GetCount() - 1))
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to write benchmark results."_s);
+
+	return maxon::OK;
+}
+
+//----------------------------------------------------------------------------------------
+/// Measures a command on a freshly loaded scene. The scene is reloaded for each run so that
+/// every run starts from the same selection and objects.
+/// @param[in] file								The output file.
+/// @param[in] caseName						The name of the benchmark case.
+/// @param[in] sceneName					The file name of the scene in the plugin folder.
+/// @param[in] commandID					The ID of the command to execute.
+/// @param[in] warmupRuns					The number of runs executed before the measured runs, e.g. to fill a cache.
+/// @param[in] executePasses			True to also measure the evaluation of the document, for commands creating generators.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+static maxon::Result<void> BenchmarkCommand(BaseFile& file, const String& caseName, const String& sceneName, Int32 commandID, Int warmupRuns = 0, Bool executePasses = false)
+{
+	iferr_scope;
+
+	maxon::BaseArray<Float> times;
+	times.EnsureCapacity(BENCHMARK_REPETITIONS) iferr_return;
+
+	Int sceneObjects	 = 0;
+	Int createdObjects = 0;
+
+	for (Int rep = -warmupRuns; rep < BENCHMARK_REPETITIONS; ++rep)
+	{
+		BaseDocument* const doc = LoadScene(sceneName) iferr_return;
+
+		// commands work on the active document
+		InsertBaseDocument(doc);
+		SetActiveDocument(doc);
+
+		sceneObjects = CountObjects(doc->GetFirstObject());
+
+		const maxon::TimeValue start = maxon::TimeValue::GetTime();
+		CallCommand(commandID);
+		if (executePasses)
+			doc->ExecutePasses(nullptr, true, true, true, BUILDFLAGS::NONE);
+		const maxon::TimeValue duration = maxon::TimeValue::GetTime() - start;
+
+		createdObjects = CountObjects(doc->GetFirstObject()) - sceneObjects;
+
+		KillDocument(doc);
+
+		if (rep >= 0)
+			times.Append(duration.GetMilliseconds()) iferr_return;
+	}
+
+	WriteResult(file, caseName, sceneName, sceneObjects, times, createdObjects) iferr_return;
+
+	return maxon::OK;
+}
+
+//----------------------------------------------------------------------------------------
+/// Fills the given array with sample positions on a regular grid.
+/// @param[out] positions					The array to fill.
+/// @param[in] count							The number of positions.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+static maxon::Result<void> PrepareSamplePositions(maxon::BaseArray<maxon::Vector>& positions, Int count)
+{
+	iferr_scope;
+
+	positions.Resize(count) iferr_return;
+
+	// cubic grid of 1000 units centered at the origin
+	const Int		dimension = maxon::Max(Int(2), Int(maxon::Ceil(maxon::Pow(Float(count), 1.0 / 3.0))));
+	const Float step			= 1000.0 / Float(dimension - 1);
+
+	for (Int i = 0; i < count; ++i)
+	{
+		positions[i].x = Float(i % dimension) * step - 500.0;
+		positions[i].y = Float((i / dimension) % dimension) * step - 500.0;
+		positions[i].z = Float(i / (dimension * dimension)) * step - 500.0;
+	}
+
+	return maxon::OK;
+}
+
+//----------------------------------------------------------------------------------------
+/// Measures the sampling of the first field object and of the field list of the first plain
+/// effector found in a scene, with increasing numbers of sample points.
+/// @param[in] file								The output file.
+/// @param[in] sceneName					The file name of the scene in the plugin folder.
+/// @param[in] maxSize						The largest number of sample points.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+static maxon::Result<void> BenchmarkFieldSampling(BaseFile& file, const String& sceneName, Int maxSize)
+{
+	iferr_scope;
+
+	BaseDocument* doc = LoadScene(sceneName) iferr_return;
+
+	finally
+	{
+		BaseDocument::Free(doc);
+	};
+
+	FieldObject* const fieldObject	 = static_cast<FieldObject*>(FindObject(doc->GetFirstObject(), Ofield));
+	BaseObject* const	 plainEffector = FindObject(doc->GetFirstObject(), BENCHMARK_PLAIN_EFFECTOR);
+
+	FieldList* fieldList = nullptr;
+	GeData		 data;
+	if (plainEffector != nullptr && plainEffector->GetParameter(DescID(FIELDS), data, DESCFLAGS_GET::NONE))
+		fieldList = static_cast<FieldList*>(data.GetCustomDataType(CUSTOMDATATYPE_FIELDLIST));
+
+	// we need to fake the caller since we sample the field outside of a generator
+	AutoAlloc<BaseList2D> caller { Onull };
+	if (caller == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	maxon::BaseArray<maxon::Vector> positions;
+	maxon::BaseArray<Float>					times;
+	times.EnsureCapacity(BENCHMARK_REPETITIONS) iferr_return;
+
+	for (Int size = 1000; size <= maxSize; size *= 10)
+	{
+		PrepareSamplePositions(positions, size) iferr_return;
+
+		const FieldInput points(positions.GetFirst(), size, Matrix());
+
+		if (fieldObject != nullptr)
+		{
+			FieldOutput results;
+			results.Resize(size, FIELDSAMPLE_FLAG::VALUE) iferr_return;
+			FieldOutputBlock block = results.GetBlock();
+
+			const FieldInfo info = FieldInfo::Create(caller, points, FIELDSAMPLE_FLAG::VALUE) iferr_return;
+
+			times.Flush();
+			for (Int rep = 0; rep < BENCHMARK_REPETITIONS; ++rep)
+			{
+				const maxon::TimeValue start = maxon::TimeValue::GetTime();
+				SampleFieldObjectValues(*fieldObject, points, info, block) iferr_return;
+				const maxon::TimeValue duration = maxon::TimeValue::GetTime() - start;
+
+				times.Append(duration.GetMilliseconds()) iferr_return;
+			}
+
+			WriteResult(file, "sample_field_object"_s, sceneName, size, times, 0) iferr_return;
+		}
+
+		if (fieldList != nullptr)
+		{
+			times.Flush();
+			for (Int rep = 0; rep < BENCHMARK_REPETITIONS; ++rep)
+			{
+				const maxon::TimeValue start = maxon::TimeValue::GetTime();
+				const FieldOutput results = fieldList->SampleListSimple(*plainEffector, points, FIELDSAMPLE_FLAG::VALUE) iferr_return;
+				const maxon::TimeValue duration = maxon::TimeValue::GetTime() - start;
+
+				times.Append(duration.GetMilliseconds()) iferr_return;
+			}
+
+			WriteResult(file, "sample_field_list"_s, sceneName, size, times, 0) iferr_return;
+		}
+	}
+
+	return maxon::OK;
+}
+
+maxon::Result<void> RunR20FeaturesBenchmark(const Filename& csvFile)
+{
+	iferr_scope;
+
+	AutoAlloc<BaseFile> file;
+	if (file == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	if (!file->Open(csvFile, FILEOPEN::WRITE, FILEDIALOG::NONE))
+		return maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(csvFile, MAXONCONVERTMODE::NONE), "Failed to open benchmark output file."_s);
+
+	const String header = "case,scene,size,median_ms,p95_ms,created_objects\n"_s;
+	const maxon::BaseArray<Char> cHeader = header.GetCString() iferr_return;
+	if (!file->WriteBytes(cHeader.GetFirst(), cHeader.GetCount() - 1))
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to write benchmark results."_s);
+
+	// the field list command would read the results of the previous runs from the field sample cache,
+	// it is disabled so that it measures the sampling
+	const Bool cacheEnabled = IsFieldSampleCacheEnabled();
+	SetFieldSampleCacheEnabled(false);
+
+	finally
+	{
+		SetFieldSampleCacheEnabled(cacheEnabled);
+	};
+
+	// the commands run on the objects selected in the bundled scenes, their size is the scene size
+	BenchmarkCommand(*file, "create_volume_builder"_s, "1_volumes_1_volume_builder.c4d"_s, 1050257) iferr_return;
+	BenchmarkCommand(*file, "read_volume"_s, "1_volumes_2_read_volume.c4d"_s, 1050258) iferr_return;
+	BenchmarkCommand(*file, "create_volume"_s, "1_volumes_4_volume_tools.c4d"_s, 1050265) iferr_return;
+	BenchmarkCommand(*file, "combine_objects"_s, "1_volumes_4_volume_tools.c4d"_s, 1050266) iferr_return;
+	BenchmarkCommand(*file, "sample_fieldobject_command"_s, "2_fields_1_sample_field.c4d"_s, 1050268) iferr_return;
+	BenchmarkCommand(*file, "sample_fieldlist_command"_s, "2_fields_2_sample_list.c4d"_s, 1050269) iferr_return;
+	BenchmarkCommand(*file, "read_multiinstance"_s, "3_multiinstance_1_read.c4d"_s, 1050288) iferr_return;
+	BenchmarkCommand(*file, "create_multiinstance"_s, "3_multiinstance_2_create.c4d"_s, 1050287) iferr_return;
+	BenchmarkCommand(*file, "create_field_multiinstance"_s, "3_multiinstance_2_create.c4d"_s, 1050289, 0, true) iferr_return;
+
+	// the same command reading the field sample cache, filled by a warmup run
+	SetFieldSampleCacheEnabled(true);
+	BenchmarkCommand(*file, "sample_fieldlist_command_cache_warm"_s, "2_fields_2_sample_list.c4d"_s, 1050269, 1) iferr_return;
+	SetFieldSampleCacheEnabled(false);
+
+	// the field plugins are measured through the sampling paths at increasing sizes
+	// the next neighbor layer is quadratic in the number of points, so its sizes are capped
+	BenchmarkFieldSampling(*file, "2_fields_1_sample_field.c4d"_s, 1000000) iferr_return;
+	BenchmarkFieldSampling(*file, "2_fields_2_sample_list.c4d"_s, 1000000) iferr_return;
+	BenchmarkFieldSampling(*file, "2_fields_3_checkerbox_field.c4d"_s, 1000000) iferr_return;
+	BenchmarkFieldSampling(*file, "2_fields_4_distance_layer.c4d"_s, 10000) iferr_return;
+
+	file->Close();
+
+	return maxon::OK;
+}
@@ -0,0 +1,363 @@
+// local header files and resources
+#include "fieldcache.h"
+#include "profiling.h"
+
+// classic API header files
+#include "c4d_general.h"
+#include "c4d_basedocument.h"
+
+// MAXON API header files
+#include "maxon/basearray.h"
+
+/// Identifies a field sample cache file, "R20F".
+static const Int32 FIELDCACHE_MAGIC = 0x52323046;
+
+/// Version of the cache file layout.
+static const Int32 FIELDCACHE_VERSION = 2;
+
+/// Number of points written or read at once.
+static const Int FIELDCACHE_CHUNK = 65536;
+
+/// Channels stored in a cache file in addition to positions and values.
+enum FIELDCACHE_CHANNEL
+{
+	FIELDCACHE_CHANNEL_COLOR			= 1 << 0,
+	FIELDCACHE_CHANNEL_DIRECTION	= 1 << 1
+};
+
+// File layout, native byte order:
+// Int32 magic, Int32 version, UInt64 content hash, Int32 channels, UInt64 points hash, Int64 count,
+// then for each chunk of up to FIELDCACHE_CHUNK points:
+// Vector32 positions[n], Float32 values[n], Vector32 colors[n] (optional), Vector32 directions[n] (optional).
+
+/// The cache is opt-in, see SetFieldSampleCacheEnabled().
+static Bool g_fieldSampleCacheEnabled = false;
+
+void SetFieldSampleCacheEnabled(Bool enabled)
+{
+	g_fieldSampleCacheEnabled = enabled;
+}
+
+Bool IsFieldSampleCacheEnabled()
+{
+	return g_fieldSampleCacheEnabled;
+}
+
+//----------------------------------------------------------------------------------------
+/// FNV-1a hash on 64-bit words and on bytes.
+//----------------------------------------------------------------------------------------
+class FieldCacheHash
+{
+public:
+	void Mix(Float64 value)
+	{
+		UInt64 word;
+		memcpy(&word, &value, sizeof(word));
+		_hash = (_hash ^ word) * 1099511628211ULL;
+	}
+
+	void MixBytes(const void* data, Int size)
+	{
+		const UChar* const bytes = static_cast<const UChar*>(data);
+		for (Int i = 0; i < size; ++i)
+			_hash = (_hash ^ bytes[i]) * 1099511628211ULL;
+	}
+
+	UInt64 GetHash() const { return _hash; }
+
+private:
+	UInt64 _hash = 14695981039346656037ULL;
+};
+
+//----------------------------------------------------------------------------------------
+/// Adds the content of a container to a hash. The container is serialized to memory, so that
+/// custom data types like splines and gradients are covered as well.
+/// @param[in,out] hash						The hash to extend.
+/// @param[in] bc									The container to hash.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+static maxon::Result<void> MixContainer(FieldCacheHash& hash, const BaseContainer& bc)
+{
+	AutoAlloc<MemoryFileStruct> memory;
+	AutoAlloc<HyperFile>				hf;
+	if (memory == nullptr || hf == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	if (!hf->Open(0, memory->GetFilename(), FILEOPEN::WRITE, FILEDIALOG::NONE))
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to serialize a container."_s);
+
+	const Bool written = hf->WriteContainer(bc);
+	hf->Close();
+	if (!written)
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION, "Failed to serialize a container."_s);
+
+	void* data = nullptr;
+	Int		size = 0;
+	memory->GetData(data, size, false);
+	hash.MixBytes(data, size);
+
+	return maxon::OK;
+}
+
+//----------------------------------------------------------------------------------------
+/// Adds the content of a list of field layers and of their children to a hash.
+/// @param[in,out] hash						The hash to extend.
+/// @param[in] layer							The first layer of the list.
+/// @param[in] doc								The document of the field list, used to resolve the linked objects.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+static maxon::Result<void> MixFieldLayers(FieldCacheHash& hash, FieldLayer* layer, BaseDocument* doc)
+{
+	iferr_scope;
+
+	for (; layer != nullptr; layer = layer->GetNext())
+	{
+		hash.Mix(Float64(layer->GetType()));
+		MixContainer(hash, *layer->GetDataInstance()) iferr_return;
+
+		// object layers sample a field object of the scene, its parameters and position matter
+		BaseList2D* const linked = layer->GetLinkedObject(doc);
+		if (linked != nullptr)
+		{
+			hash.Mix(Float64(linked->GetType()));
+			MixContainer(hash, *linked->GetDataInstance()) iferr_return;
+
+			if (linked->IsInstanceOf(Obase))
+			{
+				const Matrix mg = static_cast<BaseObject*>(linked)->GetMg();
+				for (const Vector& v : { mg.off, mg.sqmat.v1, mg.sqmat.v2, mg.sqmat.v3 })
+				{
+					hash.Mix(v.x);
+					hash.Mix(v.y);
+					hash.Mix(v.z);
+				}
+			}
+		}
+
+		MixFieldLayers(hash, layer->GetDown(), doc) iferr_return;
+	}
+
+	return maxon::OK;
+}
+
+maxon::Result<UInt64> HashFieldListContent(FieldList& fieldList, BaseObject& caller)
+{
+	iferr_scope;
+
+	FieldCacheHash hash;
+
+	// the parameters of the caller include the field list itself
+	MixContainer(hash, *caller.GetDataInstance()) iferr_return;
+
+	BaseDocument* const doc = caller.GetDocument();
+	if (doc != nullptr)
+		hash.Mix(doc->GetTime().Get());
+
+	GeListHead* const layers = fieldList.GetLayersRoot();
+	if (layers != nullptr)
+		MixFieldLayers(hash, static_cast<FieldLayer*>(layers->GetFirst()), doc) iferr_return;
+
+	return hash.GetHash();
+}
+
+UInt64 HashFieldInput(const FieldInput& points)
+{
+	FieldCacheHash hash;
+
+	hash.Mix(Float64(points._blockCount));
+
+	const Matrix& transform = points._transform;
+	for (const Vector& v : { transform.off, transform.sqmat.v1, transform.sqmat.v2, transform.sqmat.v3 })
+	{
+		hash.Mix(v.x);
+		hash.Mix(v.y);
+		hash.Mix(v.z);
+	}
+
+	for (Int i = 0; i < points._blockCount; ++i)
+	{
+		const Vector& pos = points._position[i];
+		hash.Mix(pos.x);
+		hash.Mix(pos.y);
+		hash.Mix(pos.z);
+	}
+
+	return hash.GetHash();
+}
+
+maxon::Result<void> WriteFieldSampleCache(const Filename& file, UInt64 contentHash, const FieldInput& points, const FieldOutput& results)
+{
+	iferr_scope;
+
+	R20FEATURES_PROFILE_SCOPE("WriteFieldSampleCache");
+
+	const Int count = points._blockCount;
+	if (results._value.GetCount() < count)
+		return maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION, "The results don't match the points."_s);
+
+	Int32 channels = 0;
+	if (results._color.GetCount() >= count)
+		channels |= FIELDCACHE_CHANNEL_COLOR;
+	if (results._direction.GetCount() >= count)
+		channels |= FIELDCACHE_CHANNEL_DIRECTION;
+
+	AutoAlloc<BaseFile> bf;
+	if (bf == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	if (!bf->Open(file, FILEOPEN::WRITE, FILEDIALOG::NONE))
+		return maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(file, MAXONCONVERTMODE::NONE), "Failed to open the field cache file."_s);
+
+	Bool written = bf->WriteInt32(FIELDCACHE_MAGIC) && bf->WriteInt32(FIELDCACHE_VERSION);
+	written = written && bf->WriteUInt64(contentHash) && bf->WriteInt32(channels);
+	written = written && bf->WriteUInt64(HashFieldInput(points)) && bf->WriteInt64(Int64(count));
+
+	// chunk buffers converting to the compact representation
+	maxon::BaseArray<maxon::Vector32> vectors;
+	maxon::BaseArray<Float32>					values;
+	vectors.Resize(maxon::Min(count, FIELDCACHE_CHUNK)) iferr_return;
+	values.Resize(maxon::Min(count, FIELDCACHE_CHUNK)) iferr_return;
+
+	for (Int start = 0; written && start < count; start += FIELDCACHE_CHUNK)
+	{
+		const Int n = maxon::Min(FIELDCACHE_CHUNK, count - start);
+
+		for (Int i = 0; i < n; ++i)
+			vectors[i] = maxon::Vector32(points._position[start + i]);
+		written = bf->WriteBytes(vectors.GetFirst(), n * sizeof(maxon::Vector32));
+
+		for (Int i = 0; i < n; ++i)
+			values[i] = Float32(results._value[start + i]);
+		written = written && bf->WriteBytes(values.GetFirst(), n * sizeof(Float32));
+
+		if (written && (channels & FIELDCACHE_CHANNEL_COLOR))
+		{
+			for (Int i = 0; i < n; ++i)
+				vectors[i] = maxon::Vector32(results._color[start + i]);
+			written = bf->WriteBytes(vectors.GetFirst(), n * sizeof(maxon::Vector32));
+		}
+
+		if (written && (channels & FIELDCACHE_CHANNEL_DIRECTION))
+		{
+			for (Int i = 0; i < n; ++i)
+				vectors[i] = maxon::Vector32(results._direction[start + i]);
+			written = bf->WriteBytes(vectors.GetFirst(), n * sizeof(maxon::Vector32));
+		}
+	}
+
+	if (!written || !bf->Close())
+		return maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(file, MAXONCONVERTMODE::NONE), "Failed to write the field cache file."_s);
+
+	return maxon::OK;
+}
+
+maxon::Result<Bool> ReadFieldSampleCache(const Filename& file, UInt64 contentHash, const FieldInput& points, FIELDSAMPLE_FLAG flags, FieldOutput& results)
+{
+	iferr_scope;
+
+	R20FEATURES_PROFILE_SCOPE("ReadFieldSampleCache");
+
+	if (!GeFExist(file))
+		return false;
+
+	AutoAlloc<BaseFile> bf;
+	if (bf == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	if (!bf->Open(file, FILEOPEN::READ, FILEDIALOG::NONE))
+		return false;
+
+	// check the header against the requested sampling
+	Int32	 magic = 0, version = 0, channels = 0;
+	UInt64 content = 0;
+	UInt64 pointsHash = 0;
+	Int64	 count = 0;
+
+	Bool read = bf->ReadInt32(&magic) && bf->ReadInt32(&version) && bf->ReadUInt64(&content);
+	read = read && bf->ReadInt32(&channels) && bf->ReadUInt64(&pointsHash) && bf->ReadInt64(&count);
+
+	if (!read || magic != FIELDCACHE_MAGIC || version != FIELDCACHE_VERSION || content != contentHash || count != points._blockCount)
+		return false;
+
+	const Bool needColor = (flags & FIELDSAMPLE_FLAG::COLOR) == FIELDSAMPLE_FLAG::COLOR;
+	const Bool needDirection = (flags & FIELDSAMPLE_FLAG::DIRECTION) == FIELDSAMPLE_FLAG::DIRECTION;
+	if ((needColor && !(channels & FIELDCACHE_CHANNEL_COLOR)) || (needDirection && !(channels & FIELDCACHE_CHANNEL_DIRECTION)))
+		return false;
+
+	if (pointsHash != HashFieldInput(points))
+		return false;
+
+	FIELDSAMPLE_FLAG outputFlags = FIELDSAMPLE_FLAG::VALUE;
+	if (channels & FIELDCACHE_CHANNEL_COLOR)
+		outputFlags |= FIELDSAMPLE_FLAG::COLOR;
+	if (channels & FIELDCACHE_CHANNEL_DIRECTION)
+		outputFlags |= FIELDSAMPLE_FLAG::DIRECTION;
+
+	results.Resize(Int(count), outputFlags) iferr_return;
+
+	maxon::BaseArray<maxon::Vector32> vectors;
+	maxon::BaseArray<Float32>					values;
+	vectors.Resize(maxon::Min(Int(count), FIELDCACHE_CHUNK)) iferr_return;
+	values.Resize(maxon::Min(Int(count), FIELDCACHE_CHUNK)) iferr_return;
+
+	for (Int start = 0; start < count; start += FIELDCACHE_CHUNK)
+	{
+		const Int n = maxon::Min(FIELDCACHE_CHUNK, Int(count) - start);
+		const Int vectorBytes = n * sizeof(maxon::Vector32);
+		const Int valueBytes = n * sizeof(Float32);
+
+		// the positions are covered by the hash, skip them
+		if (!bf->Seek(vectorBytes, FILESEEK::RELATIVE))
+			return false;
+
+		if (bf->ReadBytes(values.GetFirst(), valueBytes, true) != valueBytes)
+			return false;
+		for (Int i = 0; i < n; ++i)
+			results._value[start + i] = Float(values[i]);
+
+		if (channels & FIELDCACHE_CHANNEL_COLOR)
+		{
+			if (bf->ReadBytes(vectors.GetFirst(), vectorBytes, true) != vectorBytes)
+				return false;
+			for (Int i = 0; i < n; ++i)
+				results._color[start + i] = Vector(vectors[i]);
+		}
+
+		if (channels & FIELDCACHE_CHANNEL_DIRECTION)
+		{
+			if (bf->ReadBytes(vectors.GetFirst(), vectorBytes, true) != vectorBytes)
+				return false;
+			for (Int i = 0; i < n; ++i)
+				results._direction[start + i] = Vector(vectors[i]);
+		}
+	}
+
+	return true;
+}
+
+maxon::Result<FieldOutput> SampleListCached(FieldList& fieldList, BaseObject& caller, const FieldInput& points, FIELDSAMPLE_FLAG flags, const String& cacheName)
+{
+	iferr_scope;
+
+	if (!g_fieldSampleCacheEnabled)
+		return fieldList.SampleListSimple(caller, points, flags);
+
+	// one cache file per cache name and document, so that documents don't replace each other's caches
+	BaseDocument* const doc = caller.GetDocument();
+	const String				docName = doc != nullptr ? doc->GetDocumentName().GetString() : String();
+	const Filename			cacheFile = GeGetC4DPath(C4D_PATH::PREFS) + Filename(FormatString("r20features_fieldcache_@_@.bin", cacheName, docName));
+	const UInt64				contentHash = HashFieldListContent(fieldList, caller) iferr_return;
+
+	FieldOutput results;
+	const Bool cached = ReadFieldSampleCache(cacheFile, contentHash, points, flags, results) iferr_return;
+	if (cached)
+		return std::move(results);
+
+	results = fieldList.SampleListSimple(caller, points, flags) iferr_return;
+
+	// the cache is an optimization, failing to store it is not an error of the sampling
+	iferr (WriteFieldSampleCache(cacheFile, contentHash, points, results))
+		DiagnosticOutput("Field sample cache not written: @", err);
+
+	return std::move(results);
+}
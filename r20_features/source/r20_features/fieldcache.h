@@ -0,0 +1,79 @@
+#ifndef DEVKITCHEN18_R20_FIELDCACHE_H__
+#define DEVKITCHEN18_R20_FIELDCACHE_H__
+
+// classic API header files
+#include "c4d_file.h"
+#include "c4d_fielddata.h"
+#include "customgui_field.h"
+
+//----------------------------------------------------------------------------------------
+/// Enables or disables the field sample cache of SampleListCached() for the session.
+/// The cache is disabled by default, no cache files are read or written until it is enabled.
+/// @param[in] enabled						True to enable the cache.
+//----------------------------------------------------------------------------------------
+void SetFieldSampleCacheEnabled(Bool enabled);
+
+//----------------------------------------------------------------------------------------
+/// Returns if the field sample cache of SampleListCached() is enabled.
+/// @return												True if enabled.
+//----------------------------------------------------------------------------------------
+Bool IsFieldSampleCacheEnabled();
+
+//----------------------------------------------------------------------------------------
+/// Hashes the content determining the result of a field list sampling: the parameters of the
+/// caller including the field list, the parameters of all layers, the parameters and global
+/// matrices of the objects linked by the layers and the document time. External data referenced
+/// by the parameters, e.g. the content of a bitmap file, is not part of the hash.
+/// @param[in] fieldList					The field list to hash.
+/// @param[in] caller							The object owning the field list.
+/// @return												The 64-bit hash of the content.
+//----------------------------------------------------------------------------------------
+maxon::Result<UInt64> HashFieldListContent(FieldList& fieldList, BaseObject& caller);
+
+//----------------------------------------------------------------------------------------
+/// Hashes the sample positions and the transform of a FieldInput.
+/// @param[in] points							The sampled points.
+/// @return												The 64-bit hash of the point set.
+//----------------------------------------------------------------------------------------
+UInt64 HashFieldInput(const FieldInput& points);
+
+//----------------------------------------------------------------------------------------
+/// Writes the positions and the results of a field sampling into a binary cache file.
+/// The file is written in chunks, so no second copy of the data is held in memory.
+/// The values are stored as Float32, positions, colors and directions as Vector32.
+/// @param[in] file								The cache file to write.
+/// @param[in] contentHash				The content hash of the sampled field list, see HashFieldListContent().
+/// @param[in] points							The sampled points.
+/// @param[in] results						The sampling results. Colors and directions are stored if present.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+maxon::Result<void> WriteFieldSampleCache(const Filename& file, UInt64 contentHash, const FieldInput& points, const FieldOutput& results);
+
+//----------------------------------------------------------------------------------------
+/// Reads the results of a field sampling from a binary cache file written by WriteFieldSampleCache().
+/// The file is read in chunks directly into the output arrays.
+/// @param[in] file								The cache file to read.
+/// @param[in] contentHash				The content hash of the field list to sample, see HashFieldListContent().
+/// @param[in] points							The points to sample.
+/// @param[in] flags							The requested channels.
+/// @param[out] results						The sampling results, only valid if true is returned.
+/// @return												True if the cache matches the field list, the points and the channels, false if missing or stale.
+//----------------------------------------------------------------------------------------
+maxon::Result<Bool> ReadFieldSampleCache(const Filename& file, UInt64 contentHash, const FieldInput& points, FIELDSAMPLE_FLAG flags, FieldOutput& results);
+
+//----------------------------------------------------------------------------------------
+/// Samples a field list like FieldList::SampleListSimple(), but reuses the results stored by a previous
+/// call with the same cache name if the content of the field list and the points did not change.
+/// Only if the cache is enabled with SetFieldSampleCacheEnabled(), otherwise the field list is just sampled.
+/// The cache file is stored in the preferences folder, one per cache name and document name;
+/// a failure writing it does not fail the sampling.
+/// @param[in] fieldList					The field list to sample.
+/// @param[in] caller							The object owning the field list.
+/// @param[in] points							The points to sample.
+/// @param[in] flags							The requested channels.
+/// @param[in] cacheName					The name of the cache slot, one file is kept per name.
+/// @return												The sampling results.
+//----------------------------------------------------------------------------------------
+maxon::Result<FieldOutput> SampleListCached(FieldList& fieldList, BaseObject& caller, const FieldInput& points, FIELDSAMPLE_FLAG flags, const String& cacheName);
+
+#endif // DEVKITCHEN18_R20_FIELDCACHE_H__
@@ -2,6 +2,9 @@
 #include "r20_features.h"
 #include "c4d_symbols.h"
 #include "fcheckerboard.h"
+#include "profiling.h"
+#include "objectbatch.h"
+#include "fieldcache.h"
 
 // classic API header files
 #include "c4d_general.h"
@@ -23,6 +26,7 @@
 #include "maxon/apibase.h"
 #include "maxon/lib_math.h"
 #include "maxon/kdtree.h"
+#include "maxon/parallelfor.h"
 
 //----------------------------------------------------------------------------------------
 /// An example command that samples a field object.
@@ -38,7 +42,8 @@ public:
 
 Bool SampleFieldObjectCommand::Execute(BaseDocument* doc)
 {
-	// This example shows how to sample a field object.
+	// This example shows how to sample field objects.
+	// All selected field objects sample the same points concurrently, each with its own shared data and output.
 	// See https://developers.maxon.net/docs/Cinema4DCPPSDK/html/page_manual_fieldobject.html.
 
 	iferr_scope_handler
@@ -49,16 +54,30 @@ Bool SampleFieldObjectCommand::Execute(BaseDocument* doc)
 		return false;
 	};
 
-	// get selected object
-	BaseObject* const object = doc->GetActiveObject();
-	if (object == nullptr)
+	// prepare array for object selection
+	AutoAlloc<AtomArray> objectSelection;
+	if (objectSelection == nullptr)
+		iferr_throw(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION));
+
+	// get object selection
+	doc->GetActiveObjects(objectSelection, GETACTIVEOBJECTFLAGS::SELECTIONORDER);
+	if (objectSelection->GetCount() == 0)
 		return true;
 
-	// check if the selected object is a field
-	if (object->IsInstanceOf(Ofield) == false)
+	// collect the selected field objects
+	maxon::BaseArray<FieldObject*> fieldObjects;
+	for (Int32 i = 0; i < objectSelection->GetCount(); ++i)
+	{
+		C4DAtom* const atom = objectSelection->GetIndex(i);
+		if (atom != nullptr && atom->IsInstanceOf(Ofield))
+			fieldObjects.Append(static_cast<FieldObject*>(atom)) iferr_return;
+	}
+
+	// check if any selected object is a field
+	if (fieldObjects.IsEmpty())
 		iferr_throw(maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION));
 
-	FieldObject* const fieldObject = static_cast<FieldObject*>(object);
+	const Int fieldCnt = fieldObjects.GetCount();
 
 	// prepare "caller"
 	// we need to fake the caller since we sample the field from a CommandData plugin
@@ -88,76 +107,109 @@ Bool SampleFieldObjectCommand::Execute(BaseDocument* doc)
 		xOffset += stepSize;
 	}
 
-	// define points to sample
+	// define points to sample, shared by all fields
 	FieldInput points(positions.GetFirst(),
 										directions.GetFirst(),
 										uvws.GetFirst(),
 										sampleCnt,
 										Matrix());
 
-	// prepare results
-	FieldOutput results;
-	results.Resize(sampleCnt, FIELDSAMPLE_FLAG::VALUE) iferr_return;
-	FieldOutputBlock block = results.GetBlock();
+	// prepare results and shared data utility for each field
+	maxon::BaseArray<FieldOutput> results;
+	results.Resize(fieldCnt) iferr_return;
+
+	maxon::BaseArray<FieldShared> shared;
+	shared.Resize(fieldCnt) iferr_return;
+
+	for (FieldOutput& result : results)
+		result.Resize(sampleCnt, FIELDSAMPLE_FLAG::VALUE) iferr_return;
 
 	// define context
 	const FieldInfo info = FieldInfo::Create(caller, points, FIELDSAMPLE_FLAG::VALUE) iferr_return;
 
-	// shared data utility
-	FieldShared shared;
+	// initialize the field objects on the calling thread, they may access their document
+	MAXON_SCOPE
+	{
+		R20FEATURES_PROFILE_SCOPE("SampleFieldObjectCommand: InitSampling");
+		for (Int f = 0; f < fieldCnt; ++f)
+		{
+			iferr (fieldObjects[f]->InitSampling(info, shared[f]))
+			{
+				// free the fields initialized so far
+				for (Int initialized = 0; initialized < f; ++initialized)
+					fieldObjects[initialized]->FreeSampling(info, shared[initialized]);
+				iferr_throw(err);
+			}
+		}
+	}
 
-	// sample the field object
-	fieldObject->InitSampling(info, shared) iferr_return;
-	fieldObject->Sample(points, block, info) iferr_return;
-	fieldObject->FreeSampling(info, shared);
+	// sample all field objects concurrently, each one writes its own output block
+	const maxon::Result<void> sampleRes = maxon::ParallelFor::Dynamic(0, fieldCnt,
+		[&fieldObjects, &results, &points, &info](Int f) -> maxon::Result<void>
+		{
+			iferr_scope;
 
-	// start undo-step
-	doc->StartUndo();
+			R20FEATURES_PROFILE_SCOPE("SampleFieldObjectCommand: Sample");
+			R20FEATURES_PROFILE_COUNT("SampleFieldObjectCommand: sampled points", points._blockCount);
 
-	maxon::AggregatedError aggError;
+			FieldOutputBlock block = results[f].GetBlock();
+			fieldObjects[f]->Sample(points, block, info) iferr_return;
 
-	// create a null object for each sample point
-	for (Int32 i = 0; i < sampleCnt; ++i)
-	{
-		// allocate null object
-		BaseObject* const null = BaseObject::Alloc(Onull);
-		if (null == nullptr)
-		{
-			aggError.AddError(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't break the loop.");
-			continue;
-		}
+			return maxon::OK;
+		});
 
-		// set position
-		const Vector pos = positions[i];
-		null->SetRelPos(pos);
-
-		// set color
-		const Float	 value = block._value[i];
-		const Vector hsv = Vector(value, 1, 1);
-		const Vector color = HSVToRGB(hsv);
-		null->SetParameter(ID_BASEOBJECT_COLOR, color, DESCFLAGS_SET::NONE);
-
-		// display options
-		const Float radius = value * stepSize * 0.5;
-		null->SetParameter(NULLOBJECT_RADIUS, radius, DESCFLAGS_SET::NONE);
-		null->SetParameter(NULLOBJECT_DISPLAY, NULLOBJECT_DISPLAY_SPHERE, DESCFLAGS_SET::NONE);
-		null->SetParameter(ID_BASEOBJECT_USECOLOR, ID_BASEOBJECT_USECOLOR_ALWAYS, DESCFLAGS_SET::NONE);
-
-		// insert object
-		doc->InsertObject(null, nullptr, nullptr);
-		doc->AddUndo(UNDOTYPE::NEWOBJ, null);
+	MAXON_SCOPE
+	{
+		R20FEATURES_PROFILE_SCOPE("SampleFieldObjectCommand: FreeSampling");
+		for (Int f = 0; f < fieldCnt; ++f)
+			fieldObjects[f]->FreeSampling(info, shared[f]);
 	}
 
-	doc->EndUndo();
-
-	EventAdd();
+	if (sampleRes == maxon::FAILED)
+		iferr_throw(sampleRes.GetError());
 
-	// check if any errors occurred
-	if (aggError.GetCount() > 0)
+	// the output blocks and the names of the fields, read by the parallel initialization of the objects
+	maxon::BaseArray<FieldOutputBlock> blocks;
+	maxon::BaseArray<String>					 fieldNames;
+	blocks.EnsureCapacity(fieldCnt) iferr_return;
+	fieldNames.EnsureCapacity(fieldCnt) iferr_return;
+	for (Int f = 0; f < fieldCnt; ++f)
 	{
-		iferr_throw(aggError);
+		blocks.Append(results[f].GetBlock()) iferr_return;
+		fieldNames.Append(fieldObjects[f]->GetName()) iferr_return;
 	}
 
+	// create a row of null objects for each field, side by side along the Z-axis;
+	// all rows are inserted at once under a single parent with a single undo-step,
+	// the object index runs over the samples of each field in turn
+	InsertObjectBatch(*doc, GeLoadString(IDS_SAMPLE_FIELDOBJECT_COMMAND), Onull, fieldCnt * sampleCnt,
+		[&positions, &blocks, &fieldNames, sampleCnt, stepSize](Int index, BaseObject& null)
+		{
+			const Int f = index / sampleCnt;
+			const Int i = index % sampleCnt;
+
+			// name the object after the sampled field
+			null.SetName(fieldNames[f]);
+
+			// set position
+			const Vector pos = positions[i] + Vector(0.0, 0.0, Float(f) * stepSize);
+			null.SetRelPos(pos);
+
+			// set color
+			const Float	 value = blocks[f]._value[i];
+			const Vector hsv = Vector(value, 1, 1);
+			const Vector color = HSVToRGB(hsv);
+			null.SetParameter(ID_BASEOBJECT_COLOR, color, DESCFLAGS_SET::NONE);
+
+			// display options
+			const Float radius = value * stepSize * 0.5;
+			null.SetParameter(NULLOBJECT_RADIUS, radius, DESCFLAGS_SET::NONE);
+			null.SetParameter(NULLOBJECT_DISPLAY, NULLOBJECT_DISPLAY_SPHERE, DESCFLAGS_SET::NONE);
+			null.SetParameter(ID_BASEOBJECT_USECOLOR, ID_BASEOBJECT_USECOLOR_ALWAYS, DESCFLAGS_SET::NONE);
+		}) iferr_return;
+
+	EventAdd();
+
 	return true;
 }
 
@@ -243,56 +295,38 @@ Bool SampleFieldListCommand::Execute(BaseDocument* doc)
 										sampleCnt,
 										Matrix());
 
-	// sample
-	FieldOutput results = fieldList->SampleListSimple(*plainEffector, points) iferr_return;
-
-	// create a null object for each sample point
-
-	doc->StartUndo();
-
-	maxon::AggregatedError aggError;
-
-	for (Int32 i = 0; i < sampleCnt; ++i)
+	// sample, or reuse the results of a previous run if the cache is enabled and neither the field list nor the points changed
+	FieldOutput results;
+	MAXON_SCOPE
 	{
-		// allocate null object
-		BaseObject* const null = BaseObject::Alloc(Onull);
-		if (null == nullptr)
-		{
-			aggError.AddError(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't break the loop.");
-			continue;
-		}
-
-		// set position
-		const Vector pos = positions[i];
-		const Float	 value = results._value[i];
-		null->SetRelPos(pos);
-
-		// set color
-		const Vector hsv = Vector(value, 1, 1);
-		const Vector color = HSVToRGB(hsv);
-		null->SetParameter(ID_BASEOBJECT_COLOR, color, DESCFLAGS_SET::NONE);
-
-		// set display options
-		const Float radius = value * stepSize * 0.5;
-		null->SetParameter(NULLOBJECT_RADIUS, radius, DESCFLAGS_SET::NONE);
-		null->SetParameter(NULLOBJECT_DISPLAY, NULLOBJECT_DISPLAY_SPHERE, DESCFLAGS_SET::NONE);
-		null->SetParameter(ID_BASEOBJECT_USECOLOR, ID_BASEOBJECT_USECOLOR_ALWAYS, DESCFLAGS_SET::NONE);
-
-		// insert object
-		doc->InsertObject(null, nullptr, nullptr);
-		doc->AddUndo(UNDOTYPE::NEWOBJ, null);
+		R20FEATURES_PROFILE_SCOPE("SampleFieldListCommand: SampleListSimple");
+		R20FEATURES_PROFILE_COUNT("SampleFieldListCommand: sampled points", sampleCnt);
+		results = SampleListCached(*fieldList, *plainEffector, points, FIELDSAMPLE_FLAG::VALUE, "sample_fieldlist"_s) iferr_return;
 	}
 
-	doc->EndUndo();
+	// create a null object for each sample point, all inserted at once with a single undo-step
+	InsertObjectBatch(*doc, GeLoadString(IDS_SAMPLE_FIELDLIST_COMMAND), Onull, sampleCnt,
+		[&positions, &results, stepSize](Int i, BaseObject& null)
+		{
+			// set position
+			const Vector pos = positions[i];
+			const Float	 value = results._value[i];
+			null.SetRelPos(pos);
+
+			// set color
+			const Vector hsv = Vector(value, 1, 1);
+			const Vector color = HSVToRGB(hsv);
+			null.SetParameter(ID_BASEOBJECT_COLOR, color, DESCFLAGS_SET::NONE);
+
+			// set display options
+			const Float radius = value * stepSize * 0.5;
+			null.SetParameter(NULLOBJECT_RADIUS, radius, DESCFLAGS_SET::NONE);
+			null.SetParameter(NULLOBJECT_DISPLAY, NULLOBJECT_DISPLAY_SPHERE, DESCFLAGS_SET::NONE);
+			null.SetParameter(ID_BASEOBJECT_USECOLOR, ID_BASEOBJECT_USECOLOR_ALWAYS, DESCFLAGS_SET::NONE);
+		}) iferr_return;
 
 	EventAdd();
 
-	// check if any errors occurred
-	if (aggError.GetCount() > 0)
-	{
-		iferr_throw(aggError);
-	}
-
 	return true;
 };
 
@@ -303,6 +337,39 @@ SampleFieldListCommand* SampleFieldListCommand::Alloc()
 
 
 
+//----------------------------------------------------------------------------------------
+/// A command enabling or disabling the field sample cache used by the field list commands.
+//----------------------------------------------------------------------------------------
+class FieldSampleCacheCommand : public CommandData
+{
+	INSTANCEOF(FieldSampleCacheCommand, CommandData)
+
+public:
+	Bool Execute(BaseDocument* doc);
+	Int32 GetState(BaseDocument* doc);
+	static FieldSampleCacheCommand* Alloc();
+};
+
+Bool FieldSampleCacheCommand::Execute(BaseDocument* doc)
+{
+	SetFieldSampleCacheEnabled(!IsFieldSampleCacheEnabled());
+
+	return true;
+}
+
+Int32 FieldSampleCacheCommand::GetState(BaseDocument* doc)
+{
+	// the menu entry is checked while the cache is enabled
+	return CMD_ENABLED | (IsFieldSampleCacheEnabled() ? CMD_VALUE : 0);
+}
+
+FieldSampleCacheCommand* FieldSampleCacheCommand::Alloc()
+{
+	return NewObjClear(FieldSampleCacheCommand);
+}
+
+
+
 //----------------------------------------------------------------------------------------
 /// An example field subdividing space in a checkerboard pattern.
 /// See https://developers.maxon.net/docs/Cinema4DCPPSDK/html/page_manual_fielddata.html-
@@ -520,6 +587,9 @@ maxon::Result<void> NextNeighborDistanceFieldLayer::Sample(const FieldLayer& lay
 {
 	iferr_scope;
 
+	R20FEATURES_PROFILE_SCOPE("NextNeighborDistanceFieldLayer::Sample");
+	R20FEATURES_PROFILE_COUNT("NextNeighborDistanceFieldLayer::Sample: sampled points", inputs._blockCount);
+
 	// check if outputs are prepared
 	if (outputs._value.IsEmpty())
 		return maxon::OK;
@@ -585,6 +655,11 @@ void RegisterMographFieldsExamples()
 		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
 
 
+	const Bool cacheCommandRes = RegisterCommandPlugin(1050293, GeLoadString(IDS_FIELD_SAMPLE_CACHE_COMMAND), 0, nullptr, ""_s, FieldSampleCacheCommand::Alloc());
+	if (cacheCommandRes == false)
+		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
+
+
 	const String checkerboardFieldName = GeLoadString(IDS_FCHECKERBOX);
 	const Bool	 fieldObjectRes = RegisterFieldPlugin(1050278, checkerboardFieldName, checkerboardFieldName, 0, CheckerboardField::Alloc, "Fcheckerboard"_s, nullptr, 0);
 	if (fieldObjectRes == false)
@@ -1,16 +1,23 @@
 // local header files and resources
 #include "r20_features.h"
 #include "c4d_symbols.h"
+#include "profiling.h"
+#include "objectbatch.h"
+#include "ofieldmultiinstance.h"
 
 // classic API header files
 #include "c4d_general.h"
 #include "c4d_commanddata.h"
+#include "c4d_objectdata.h"
 #include "c4d_basedocument.h"
 #include "c4d_resource.h"
+#include "c4d_fielddata.h"
 #include "lib_instanceobject.h"
+#include "customgui_field.h"
 
 // parameter IDs
 #include "oinstance.h"
+#include "ofalloff_panel.h"
 
 //----------------------------------------------------------------------------------------
 /// An example command creating an instance object.
@@ -74,22 +81,32 @@ Bool CreateMultiInstanceCommand::Execute(BaseDocument* doc)
 	Float				hue	 = 0.0;
 	const Float hueStep = 1.0 / count;
 
-	for (Int i = 0; i < count; ++i)
+	MAXON_SCOPE
 	{
-		// matrices
-		matrices[i] = MatrixMove(Vector(position, 0.0, 0.0));
-		position += step;
-
-		// colors
-		const Vector colorHSV = Vector(hue, 1.0, 1.0);
-		const Vector colorRGB = HSVToRGB(colorHSV);
-		colors[i] = maxon::Color64(colorRGB);
-		hue += hueStep;
+		R20FEATURES_PROFILE_SCOPE("CreateMultiInstanceCommand: build instance arrays");
+		R20FEATURES_PROFILE_COUNT("CreateMultiInstanceCommand: instances", count);
+
+		for (Int i = 0; i < count; ++i)
+		{
+			// matrices
+			matrices[i] = MatrixMove(Vector(position, 0.0, 0.0));
+			position += step;
+
+			// colors
+			const Vector colorHSV = Vector(hue, 1.0, 1.0);
+			const Vector colorRGB = HSVToRGB(colorHSV);
+			colors[i] = maxon::Color64(colorRGB);
+			hue += hueStep;
+		}
 	}
 
 	// store data in the instance object
-	instanceObject->SetInstanceMatrices(matrices) iferr_return;
-	instanceObject->SetInstanceColors(colors) iferr_return;
+	MAXON_SCOPE
+	{
+		R20FEATURES_PROFILE_SCOPE("CreateMultiInstanceCommand: store instance arrays");
+		instanceObject->SetInstanceMatrices(matrices) iferr_return;
+		instanceObject->SetInstanceColors(colors) iferr_return;
+	}
 
 	EventAdd();
 
@@ -101,6 +118,307 @@ CreateMultiInstanceCommand* CreateMultiInstanceCommand::Alloc()
 	return NewObjClear(CreateMultiInstanceCommand);
 }
 
+/// Plugin ID of the field multi-instance generator.
+static const Int32 ID_FIELDMULTIINSTANCE_OBJECT = 1050294;
+
+/// Instances whose field value is below this scale are not created, they would be degenerated.
+static const Float FIELDMULTIINSTANCE_MIN_SCALE = 0.001;
+
+//----------------------------------------------------------------------------------------
+/// An example generator creating an instance object whose matrices and colors are driven by a field list.
+/// The instances are updated whenever the parameters, the fields, the objects used by the fields or the
+/// global matrix of the generator change, since the fields are sampled in world space.
+//----------------------------------------------------------------------------------------
+class FieldMultiInstanceObject : public ObjectData
+{
+	INSTANCEOF(FieldMultiInstanceObject, ObjectData)
+
+public:
+	static NodeData* Alloc();
+
+	virtual Bool Init(GeListNode* node);
+	virtual void CheckDirty(BaseObject* op, BaseDocument* doc);
+	virtual BaseObject* GetVirtualObjects(BaseObject* op, HierarchyHelp* hh);
+
+private:
+	//----------------------------------------------------------------------------------------
+	/// Samples the fields on a grid and creates the instance object of the cache.
+	/// @param[in] op									The generator.
+	/// @param[in] reference					The object to instance.
+	/// @return												The instance object, owned by the caller.
+	//----------------------------------------------------------------------------------------
+	maxon::Result<BaseObject*> BuildInstances(BaseObject& op, BaseObject& reference);
+
+	/// dirty checksum of the field list at the last check, the fields are not part of the dirty state of the generator
+	UInt32 _fieldsDirty = 0;
+
+	/// global matrix of the generator the fields have been sampled with
+	Matrix _sampledMg;
+};
+
+NodeData* FieldMultiInstanceObject::Alloc()
+{
+	return NewObjClear(FieldMultiInstanceObject);
+}
+
+Bool FieldMultiInstanceObject::Init(GeListNode* node)
+{
+	BaseObject* const		 op = static_cast<BaseObject*>(node);
+	BaseContainer* const bc = op->GetDataInstance();
+	if (bc == nullptr)
+		return false;
+
+	bc->SetInt32(FIELDMULTIINSTANCE_DIMENSION, 100);
+	bc->SetFloat(FIELDMULTIINSTANCE_SPACING, 50.0);
+
+	// an empty field list
+	GeData fields(CUSTOMDATATYPE_FIELDLIST, DEFAULTVALUE);
+	bc->SetData(FIELDMULTIINSTANCE_FIELDS, fields);
+
+	return true;
+}
+
+void FieldMultiInstanceObject::CheckDirty(BaseObject* op, BaseDocument* doc)
+{
+	// the field list checksum changes with the layers and with the objects they link to
+	GeData data;
+	if (!op->GetParameter(DescID(FIELDMULTIINSTANCE_FIELDS), data, DESCFLAGS_GET::NONE))
+		return;
+
+	const FieldList* const fieldList = static_cast<const FieldList*>(data.GetCustomDataType(CUSTOMDATATYPE_FIELDLIST));
+	if (fieldList == nullptr)
+		return;
+
+	const UInt32 fieldsDirty = fieldList->GetDirty(doc);
+	if (fieldsDirty != _fieldsDirty)
+	{
+		_fieldsDirty = fieldsDirty;
+		op->SetDirty(DIRTYFLAGS::DATA);
+	}
+}
+
+BaseObject* FieldMultiInstanceObject::GetVirtualObjects(BaseObject* op, HierarchyHelp* hh)
+{
+	iferr_scope_handler
+	{
+		// if an error occurred, print the error to the IDE console and trigger a debug stop
+		err.DiagOutput();
+		err.DbgStop();
+		return BaseObject::Alloc(Onull);
+	};
+
+	// reuse the cache if neither the parameters, the fields nor the generator placement changed;
+	// the global matrix is compared since moving a parent does not mark the generator dirty
+	const Matrix mg = op->GetMg();
+	const Bool	 dirty = op->CheckCache(hh) || op->IsDirty(DIRTYFLAGS::DATA) || mg != _sampledMg;
+	if (!dirty)
+		return op->GetCache(hh);
+
+	_sampledMg = mg;
+
+	BaseObject* const reference = op->GetDataInstance()->GetObjectLink(FIELDMULTIINSTANCE_REFERENCE, hh->GetDocument());
+	if (reference == nullptr)
+		return BaseObject::Alloc(Onull);
+
+	BaseObject* const instances = BuildInstances(*op, *reference) iferr_return;
+
+	return instances;
+}
+
+maxon::Result<BaseObject*> FieldMultiInstanceObject::BuildInstances(BaseObject& op, BaseObject& reference)
+{
+	iferr_scope;
+
+	R20FEATURES_PROFILE_SCOPE("FieldMultiInstanceObject::BuildInstances");
+
+	const BaseContainer* const bc = op.GetDataInstance();
+
+	GeData data;
+	if (!op.GetParameter(DescID(FIELDMULTIINSTANCE_FIELDS), data, DESCFLAGS_GET::NONE))
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION);
+
+	FieldList* const fieldList = static_cast<FieldList*>(data.GetCustomDataType(CUSTOMDATATYPE_FIELDLIST));
+	if (fieldList == nullptr)
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION);
+
+	// prepare positions, matrices and colors
+	// the arrays are allocated once and filled in place
+	const Int		dimension = maxon::Max(Int(1), Int(bc->GetInt32(FIELDMULTIINSTANCE_DIMENSION)));
+	const Int		count = dimension * dimension;
+	const Float step = bc->GetFloat(FIELDMULTIINSTANCE_SPACING);
+
+	maxon::BaseArray<maxon::Vector>	 positions;
+	maxon::BaseArray<Matrix>				 matrices;
+	maxon::BaseArray<maxon::Color64> colors;
+
+	positions.Resize(count) iferr_return;
+	matrices.EnsureCapacity(count) iferr_return;
+	colors.EnsureCapacity(count) iferr_return;
+
+	// generate positions on a grid in the XZ-plane
+	const Float offset = Float(dimension - 1) * step * 0.5;
+	for (Int i = 0; i < count; ++i)
+	{
+		positions[i].x = Float(i % dimension) * step - offset;
+		positions[i].y = 0.0;
+		positions[i].z = Float(i / dimension) * step - offset;
+	}
+
+	// define points to sample, the fields are sampled in world space
+	FieldInput points(positions.GetFirst(), count, op.GetMg());
+
+	// sample all positions in one call
+	FieldOutput results;
+	MAXON_SCOPE
+	{
+		R20FEATURES_PROFILE_SCOPE("FieldMultiInstanceObject: SampleListSimple");
+		R20FEATURES_PROFILE_COUNT("FieldMultiInstanceObject: sampled points", count);
+		results = fieldList->SampleListSimple(op, points, FIELDSAMPLE_FLAG::VALUE | FIELDSAMPLE_FLAG::COLOR) iferr_return;
+	}
+
+	// the field list might not provide color data
+	const Bool hasColors = results._color.GetCount() >= count;
+
+	// apply the field results to the instances
+	MAXON_SCOPE
+	{
+		R20FEATURES_PROFILE_SCOPE("FieldMultiInstanceObject: build instance arrays");
+
+		for (Int i = 0; i < count; ++i)
+		{
+			const Float value = results._value[i];
+
+			// a zero scale would give a degenerated matrix, skip the instance
+			if (value < FIELDMULTIINSTANCE_MIN_SCALE)
+				continue;
+
+			// matrices
+			matrices.Append(MatrixMove(positions[i]) * MatrixScale(Vector(value))) iferr_return;
+
+			// colors
+			if (hasColors)
+				colors.Append(maxon::Color64(results._color[i])) iferr_return;
+			else
+				colors.Append(maxon::Color64(value)) iferr_return;
+		}
+	}
+
+	// create instance object
+	InstanceObject* const instanceObject = InstanceObject::Alloc();
+	if (instanceObject == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	Bool completed = false;
+	finally
+	{
+		if (!completed)
+			InstanceObject::Free(instanceObject);
+	};
+
+	// use the given reference object
+	instanceObject->SetReferenceObject(&reference) iferr_return;
+
+	// set multi-instance mode
+	if (!instanceObject->SetParameter(INSTANCEOBJECT_RENDERINSTANCE_MODE, INSTANCEOBJECT_RENDERINSTANCE_MODE_MULTIINSTANCE, DESCFLAGS_SET::NONE))
+		return maxon::UnexpectedError(MAXON_SOURCE_LOCATION);
+
+	// store data in the instance object
+	MAXON_SCOPE
+	{
+		R20FEATURES_PROFILE_SCOPE("FieldMultiInstanceObject: store instance arrays");
+		instanceObject->SetInstanceMatrices(matrices) iferr_return;
+		instanceObject->SetInstanceColors(colors) iferr_return;
+	}
+
+	completed = true;
+
+	return instanceObject;
+}
+
+//----------------------------------------------------------------------------------------
+/// An example command creating a field multi-instance generator for the selected object.
+//----------------------------------------------------------------------------------------
+class CreateFieldMultiInstanceCommand : public CommandData
+{
+	INSTANCEOF(CreateFieldMultiInstanceCommand, CommandData)
+
+public:
+	Bool Execute(BaseDocument* doc);
+	static CreateFieldMultiInstanceCommand* Alloc();
+};
+
+Bool CreateFieldMultiInstanceCommand::Execute(BaseDocument* doc)
+{
+	// This example creates a field multi-instance generator. The generator places multi-instances of
+	// the selected object on a grid and scales and colorizes them with its field list.
+	// If a plain effector is selected too, its field list is copied into the generator.
+	// See https://developers.maxon.net/docs/Cinema4DCPPSDK/html/page_manual_instanceobject.html.
+	// See https://developers.maxon.net/docs/Cinema4DCPPSDK/html/page_manual_fieldlist.html.
+
+	iferr_scope_handler
+	{
+		// if an error occurred, print the error to the IDE console and trigger a debug stop
+		err.DiagOutput();
+		err.DbgStop();
+		return false;
+	};
+
+	// prepare array for object selection
+	AutoAlloc<AtomArray> objectSelection;
+	if (objectSelection == nullptr)
+		iferr_throw(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION));
+
+	// get object selection
+	doc->GetActiveObjects(objectSelection, GETACTIVEOBJECTFLAGS::SELECTIONORDER);
+
+	// the selection must contain the object to instance and may contain a plain effector
+	BaseObject* plainEffector = nullptr;
+	BaseObject* referenceObject = nullptr;
+
+	for (Int32 i = 0; i < objectSelection->GetCount(); ++i)
+	{
+		BaseObject* const object = static_cast<BaseObject*>(objectSelection->GetIndex(i));
+		if (object == nullptr)
+			continue;
+
+		// check if object is a plain effector
+		if (plainEffector == nullptr && object->IsInstanceOf(1021337))
+			plainEffector = object;
+		else if (referenceObject == nullptr)
+			referenceObject = object;
+	}
+
+	if (referenceObject == nullptr)
+		return true;
+
+	// create generator
+	BaseObject* const generator = BaseObject::Alloc(ID_FIELDMULTIINSTANCE_OBJECT);
+	if (generator == nullptr)
+		iferr_throw(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION));
+
+	generator->SetParameter(DescID(FIELDMULTIINSTANCE_REFERENCE), referenceObject, DESCFLAGS_SET::NONE);
+
+	// copy the field list of the plain effector
+	GeData data;
+	if (plainEffector != nullptr && plainEffector->GetParameter(DescID(FIELDS), data, DESCFLAGS_GET::NONE))
+		generator->SetParameter(DescID(FIELDMULTIINSTANCE_FIELDS), data, DESCFLAGS_SET::NONE);
+
+	// insert object into the scene
+	doc->StartUndo();
+	doc->InsertObject(generator, nullptr, nullptr);
+	doc->AddUndo(UNDOTYPE::NEWOBJ, generator);
+	doc->EndUndo();
+
+	EventAdd();
+
+	return true;
+}
+
+CreateFieldMultiInstanceCommand* CreateFieldMultiInstanceCommand::Alloc()
+{
+	return NewObjClear(CreateFieldMultiInstanceCommand);
+}
+
 //----------------------------------------------------------------------------------------
 /// An example command reading multi-instance data.
 //----------------------------------------------------------------------------------------
@@ -143,41 +461,17 @@ Bool ReadMultiInstancesCommand::Execute(BaseDocument* doc)
 	if (instanceCnt == 0)
 		return true;
 
-	// for each position, create a null object
-
-	doc->StartUndo();
-
-	maxon::AggregatedError aggError;
-
-	for (UInt i = 0; i < instanceCnt; ++i)
-	{
-		// allocate a null object
-		BaseObject* const nullObject = BaseObject::Alloc(Onull);
-		if (nullObject == nullptr)
+	// for each position, create a null object, all inserted at once with a single undo-step
+	InsertObjectBatch(*doc, GeLoadString(IDS_READ_MULTIINSTACE_COMMAND), Onull, Int(instanceCnt),
+		[instanceObject](Int i, BaseObject& nullObject)
 		{
-			aggError.AddError(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't break the loop.");
-			continue;
-		}
-
-		// set matrix
-		const Matrix matrix = instanceObject->GetInstanceMatrix(i);
-		nullObject->SetMg(matrix);
-
-		// insert object
-		doc->InsertObject(nullObject, nullptr, nullptr);
-		doc->AddUndo(UNDOTYPE::NEWOBJ, nullObject);
-	}
-
-	doc->EndUndo();
+			// set matrix, the parent null sits at the origin so the local matrix is the global one
+			const Matrix matrix = instanceObject->GetInstanceMatrix(UInt(i));
+			nullObject.SetMl(matrix);
+		}) iferr_return;
 
 	EventAdd();
 
-	// check if any errors occurred
-	if (aggError.GetCount() > 0)
-	{
-		iferr_throw(aggError);
-	}
-
 	return true;
 };
 
@@ -196,6 +490,16 @@ void RegisterMultiInstancesExamples()
 		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
 
 
+	const Bool fieldObjectRes = RegisterObjectPlugin(ID_FIELDMULTIINSTANCE_OBJECT, GeLoadString(IDS_FIELD_MULTIINSTANCE_OBJECT), OBJECT_GENERATOR, FieldMultiInstanceObject::Alloc, "Ofieldmultiinstance"_s, nullptr, 0);
+	if (fieldObjectRes == false)
+		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
+
+
+	const Bool fieldCommandRes = RegisterCommandPlugin(1050289, GeLoadString(IDS_CREATE_FIELD_MULTIINSTANCE_COMMAND), 0, nullptr, ""_s, CreateFieldMultiInstanceCommand::Alloc());
+	if (fieldCommandRes == false)
+		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
+
+
 	const Bool readCommandRes = RegisterCommandPlugin(1050288, GeLoadString(IDS_READ_MULTIINSTACE_COMMAND), 0, nullptr, ""_s, ReadMultiInstancesCommand::Alloc());
 	if (readCommandRes == false)
 		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
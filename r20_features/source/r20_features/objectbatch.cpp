@@ -0,0 +1,30 @@
+// local header files and resources
+#include "objectbatch.h"
+
+maxon::Result<BaseObject*> InsertObjectsUnderNull(BaseDocument& doc, const String& parentName, maxon::BaseArray<BaseObject*>& objects)
+{
+	BaseObject* const parent = BaseObject::Alloc(Onull);
+	if (parent == nullptr)
+	{
+		for (BaseObject* object : objects)
+			BaseObject::Free(object);
+		objects.Flush();
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+	}
+
+	parent->SetName(parentName);
+
+	// insert as first child in reverse order, this keeps the order of the array without walking the children
+	for (Int i = objects.GetCount() - 1; i >= 0; --i)
+		objects[i]->InsertUnder(parent);
+
+	objects.Flush();
+
+	// a single change of the document with a single undo entry
+	doc.StartUndo();
+	doc.InsertObject(parent, nullptr, nullptr);
+	doc.AddUndo(UNDOTYPE::NEWOBJ, parent);
+	doc.EndUndo();
+
+	return parent;
+}
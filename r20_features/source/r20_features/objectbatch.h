@@ -0,0 +1,67 @@
+#ifndef DEVKITCHEN18_R20_OBJECTBATCH_H__
+#define DEVKITCHEN18_R20_OBJECTBATCH_H__
+
+// classic API header files
+#include "c4d_basedocument.h"
+#include "c4d_baseobject.h"
+
+// MAXON API header files
+#include "maxon/basearray.h"
+#include "maxon/parallelfor.h"
+
+//----------------------------------------------------------------------------------------
+/// Inserts the given objects into the document under a new null object. The objects are
+/// attached to the null while it is still off-document, so the document is changed once
+/// and a single undo entry is recorded.
+/// @param[in] doc								The document to insert the objects into.
+/// @param[in] parentName					The name of the created null object.
+/// @param[in] objects						The objects to insert. The ownership is taken also in case of an error, the array is flushed.
+/// @return												The inserted null object.
+//----------------------------------------------------------------------------------------
+maxon::Result<BaseObject*> InsertObjectsUnderNull(BaseDocument& doc, const String& parentName, maxon::BaseArray<BaseObject*>& objects);
+
+//----------------------------------------------------------------------------------------
+/// Creates many objects of the same type and inserts them into the document with
+/// InsertObjectsUnderNull(). The objects are allocated and initialized in parallel.
+/// @param[in] doc								The document to insert the objects into.
+/// @param[in] parentName					The name of the created null object.
+/// @param[in] type								The type of the objects to create.
+/// @param[in] count							The number of objects to create.
+/// @param[in] init								Called as init(Int index, BaseObject& object) for each object. It is called from multiple threads,
+///																so it must only read shared data and write the given object.
+/// @return												The inserted null object.
+//----------------------------------------------------------------------------------------
+template <typename INIT>
+maxon::Result<BaseObject*> InsertObjectBatch(BaseDocument& doc, const String& parentName, Int32 type, Int count, INIT&& init)
+{
+	iferr_scope;
+
+	maxon::BaseArray<BaseObject*> objects;
+	objects.Resize(count) iferr_return;
+
+	// the objects are not part of any document yet, so they can be set up in parallel
+	maxon::ParallelFor::Dynamic(0, count,
+		[&objects, &init, type](Int i)
+		{
+			BaseObject* const object = BaseObject::Alloc(type);
+			objects[i] = object;
+
+			if (object != nullptr)
+				init(i, *object);
+		});
+
+	for (BaseObject* const object : objects)
+	{
+		if (object == nullptr)
+		{
+			for (BaseObject* allocated : objects)
+				BaseObject::Free(allocated);
+			objects.Flush();
+			return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+		}
+	}
+
+	return InsertObjectsUnderNull(doc, parentName, objects);
+}
+
+#endif // DEVKITCHEN18_R20_OBJECTBATCH_H__
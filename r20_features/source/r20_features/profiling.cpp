@@ -0,0 +1,128 @@
+// local header files and resources
+#include "r20_features.h"
+#include "profiling.h"
+#include "c4d_symbols.h"
+
+// classic API header files
+#include "c4d_general.h"
+#include "c4d_commanddata.h"
+#include "c4d_resource.h"
+
+// MAXON API header files
+#include "maxon/spinlock.h"
+
+#ifdef R20FEATURES_PROFILING
+
+/// Head of the list of all profiled call sites.
+static ProfilingSite* g_profilingSites = nullptr;
+
+/// Lock protecting the list of call sites.
+static maxon::Spinlock g_profilingLock;
+
+ProfilingSite::ProfilingSite(const Char* name) : _name(name), _next(nullptr)
+{
+	maxon::ScopedLock lock(g_profilingLock);
+	_next = g_profilingSites;
+	g_profilingSites = this;
+}
+
+void DumpProfilingSites()
+{
+	maxon::ScopedLock lock(g_profilingLock);
+
+	ApplicationOutput("Profiling sites since the last dump:");
+
+	for (ProfilingSite* site = g_profilingSites; site != nullptr; site = site->_next)
+	{
+		// read and reset the aggregates at once so that concurrent calls are not lost
+		const Int64 calls = site->_calls.SwapValue(0);
+		const Int64 nanoseconds = site->_nanoseconds.SwapValue(0);
+		const Int64 count = site->_count.SwapValue(0);
+
+		if (calls == 0 && count == 0)
+			continue;
+
+		const Float totalMs = Float(nanoseconds) * 1e-6;
+		const Float meanMs	= calls > 0 ? totalMs / Float(calls) : 0.0;
+
+		ApplicationOutput("  @: @ calls, @ ms total, @ ms per call, count @", String(site->_name), calls, totalMs, meanMs, count);
+	}
+}
+
+#else
+
+void DumpProfilingSites()
+{
+	ApplicationOutput("Profiling is not compiled in this build, define R20FEATURES_PROFILING to enable it.");
+}
+
+#endif
+
+/// Maximum number of recorded startup phases.
+static const Int STARTUP_PHASE_COUNT = 16;
+
+/// Names and durations of the startup phases, a fixed array so that recording allocates nothing.
+static const Char*			g_startupPhaseNames[STARTUP_PHASE_COUNT];
+static maxon::TimeValue g_startupPhaseDurations[STARTUP_PHASE_COUNT];
+static Int							g_startupPhaseCount = 0;
+
+void RecordStartupPhase(const Char* name, const maxon::TimeValue& duration)
+{
+	if (g_startupPhaseCount >= STARTUP_PHASE_COUNT)
+		return;
+
+	g_startupPhaseNames[g_startupPhaseCount] = name;
+	g_startupPhaseDurations[g_startupPhaseCount] = duration;
+	++g_startupPhaseCount;
+}
+
+void ReportStartupPhases()
+{
+	ApplicationOutput("Startup phases of the r20_features module:");
+
+	Float totalMs = 0.0;
+	for (Int i = 0; i < g_startupPhaseCount; ++i)
+	{
+		const Float durationMs = g_startupPhaseDurations[i].GetMilliseconds();
+		totalMs += durationMs;
+
+		ApplicationOutput("  @: @ ms", String(g_startupPhaseNames[i]), durationMs);
+	}
+
+	ApplicationOutput("  total: @ ms", totalMs);
+}
+
+//----------------------------------------------------------------------------------------
+/// A command printing the startup phases and the aggregates of the profiled call sites to the console.
+//----------------------------------------------------------------------------------------
+class DumpProfilingCommand : public CommandData
+{
+	INSTANCEOF(DumpProfilingCommand, CommandData)
+
+public:
+	Bool Execute(BaseDocument* doc);
+	static DumpProfilingCommand* Alloc();
+};
+
+Bool DumpProfilingCommand::Execute(BaseDocument* doc)
+{
+	ReportStartupPhases();
+	DumpProfilingSites();
+
+	return true;
+}
+
+DumpProfilingCommand* DumpProfilingCommand::Alloc()
+{
+	return NewObjClear(DumpProfilingCommand);
+}
+
+void RegisterProfilingCommand()
+{
+	const Bool dumpCommandRes = RegisterCommandPlugin(1050290, GeLoadString(IDS_DUMP_PROFILING_COMMAND), 0, nullptr, ""_s, DumpProfilingCommand::Alloc());
+	if (dumpCommandRes == false)
+	{
+		DiagnosticOutput("Errors registering plugins: @", maxon::UnexpectedError(MAXON_SOURCE_LOCATION));
+		DebugStop();
+	}
+}
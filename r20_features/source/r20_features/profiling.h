@@ -0,0 +1,108 @@
+#ifndef DEVKITCHEN18_R20_PROFILING_H__
+#define DEVKITCHEN18_R20_PROFILING_H__
+
+// MAXON API header files
+#include "maxon/apibase.h"
+#include "maxon/atomictypes.h"
+#include "maxon/timevalue.h"
+
+// The profiling sites are compiled in debug builds; define R20FEATURES_PROFILING to compile them
+// in release builds too. Otherwise the macros below expand to nothing.
+#if defined(MAXON_TARGET_DEBUG) && !defined(R20FEATURES_PROFILING)
+	#define R20FEATURES_PROFILING
+#endif
+
+#ifdef R20FEATURES_PROFILING
+
+//----------------------------------------------------------------------------------------
+/// Aggregated timings and counters of a profiled call site. A site is a static object created
+/// on first use, it links itself into the global list printed by DumpProfilingSites().
+//----------------------------------------------------------------------------------------
+class ProfilingSite
+{
+public:
+	//----------------------------------------------------------------------------------------
+	/// Creates the site and adds it to the global list.
+	/// @param[in] name								Name of the call site, must be a string literal.
+	//----------------------------------------------------------------------------------------
+	explicit ProfilingSite(const Char* name);
+
+	//----------------------------------------------------------------------------------------
+	/// Adds a timed call to the aggregates. Can be called from multiple threads.
+	/// @param[in] duration						The duration of the call.
+	//----------------------------------------------------------------------------------------
+	void AddCall(const maxon::TimeValue& duration)
+	{
+		_calls.SwapIncrement();
+		_nanoseconds.SwapAdd(Int64(duration.GetNanoseconds()));
+	}
+
+	//----------------------------------------------------------------------------------------
+	/// Adds a value to the counter of the site. Can be called from multiple threads.
+	/// @param[in] value							The value to add.
+	//----------------------------------------------------------------------------------------
+	void AddCount(Int64 value)
+	{
+		_count.SwapAdd(value);
+	}
+
+public:
+	const Char*				 _name;					///< name of the call site
+	ProfilingSite*		 _next;					///< next site in the global list
+	maxon::AtomicInt64 _calls;				///< number of timed calls
+	maxon::AtomicInt64 _nanoseconds;	///< total duration of the timed calls
+	maxon::AtomicInt64 _count;				///< sum of the counted values
+};
+
+//----------------------------------------------------------------------------------------
+/// Measures the lifetime of the scope it is declared in and adds it to a ProfilingSite.
+//----------------------------------------------------------------------------------------
+class ProfilingScope
+{
+public:
+	explicit ProfilingScope(ProfilingSite& site) : _site(site), _start(maxon::TimeValue::GetTime()) { }
+	~ProfilingScope() { _site.AddCall(maxon::TimeValue::GetTime() - _start); }
+
+private:
+	ProfilingSite&				 _site;
+	const maxon::TimeValue _start;
+};
+
+#define R20FEATURES_PROFILING_CONCAT_(a, b) a##b
+#define R20FEATURES_PROFILING_CONCAT(a, b) R20FEATURES_PROFILING_CONCAT_(a, b)
+
+/// Times the rest of the enclosing scope under the given site name.
+#define R20FEATURES_PROFILE_SCOPE(name) \
+	static ProfilingSite R20FEATURES_PROFILING_CONCAT(s_profilingSite, __LINE__)(name); \
+	const ProfilingScope R20FEATURES_PROFILING_CONCAT(profilingScope, __LINE__)(R20FEATURES_PROFILING_CONCAT(s_profilingSite, __LINE__))
+
+/// Adds the given value to the counter of the given site name.
+#define R20FEATURES_PROFILE_COUNT(name, value) \
+	do { static ProfilingSite s_profilingSite(name); s_profilingSite.AddCount(Int64(value)); } while (false)
+
+#else
+
+#define R20FEATURES_PROFILE_SCOPE(name)
+#define R20FEATURES_PROFILE_COUNT(name, value)
+
+#endif
+
+//----------------------------------------------------------------------------------------
+/// Prints the aggregates of all profiled call sites to the console and resets them.
+//----------------------------------------------------------------------------------------
+void DumpProfilingSites();
+
+//----------------------------------------------------------------------------------------
+/// Stores the duration of a startup phase of the module. The phases are recorded in all builds,
+/// they are only called from the main thread while the module starts.
+/// @param[in] name								Name of the phase, must be a string literal.
+/// @param[in] duration						The duration of the phase.
+//----------------------------------------------------------------------------------------
+void RecordStartupPhase(const Char* name, const maxon::TimeValue& duration);
+
+//----------------------------------------------------------------------------------------
+/// Prints the recorded startup phases and their total to the console.
+//----------------------------------------------------------------------------------------
+void ReportStartupPhases();
+
+#endif // DEVKITCHEN18_R20_PROFILING_H__
@@ -1,6 +1,8 @@
 #ifndef DEVKITCHEN18_R20_FEAUTRES_H__
 #define DEVKITCHEN18_R20_FEAUTRES_H__
 
+#include "c4d_file.h"
+
 //----------------------------------------------------------------------------------------
 /// Registers example commands handling volume objects.
 //----------------------------------------------------------------------------------------
@@ -16,4 +18,23 @@ void RegisterMographFieldsExamples();
 //----------------------------------------------------------------------------------------
 void RegisterMultiInstancesExamples();
 
+//----------------------------------------------------------------------------------------
+/// Registers the command printing the profiled call sites to the console.
+//----------------------------------------------------------------------------------------
+void RegisterProfilingCommand();
+
+/// Command line argument printing the duration of the startup phases of the module to the console.
+static const Char* const R20FEATURES_STARTUP_REPORT_ARG = "-r20features_startup_report";
+
+/// Command line argument, followed by the path of the CSV file to write, running the benchmark.
+static const Char* const R20FEATURES_BENCHMARK_ARG = "-r20features_benchmark";
+
+//----------------------------------------------------------------------------------------
+/// Runs the example commands on the bundled scenes and samples their fields at increasing sizes.
+/// The median and 95th percentile times of each case are written as CSV in the given file.
+/// @param[in] csvFile						The file to write.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+maxon::Result<void> RunR20FeaturesBenchmark(const Filename& csvFile);
+
 #endif // DEVKITCHEN18_R20_FEAUTRES_H__
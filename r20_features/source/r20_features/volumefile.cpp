@@ -0,0 +1,308 @@
+// local header files and resources
+#include "volumefile.h"
+#include "profiling.h"
+
+// MAXON API header files
+#include "maxon/hashmap.h"
+#include "maxon/parallelfor.h"
+#include "maxon/volumeiterators.h"
+#include "maxon/volumeaccessors.h"
+#include "maxon/volumetools.h"
+
+/// Identifies a volume file, "R20V".
+static const Int32 VOLUMEFILE_MAGIC = 0x52323056;
+
+/// Version of the volume file layout.
+static const Int32 VOLUMEFILE_VERSION = 2;
+
+/// Size of a tile index entry in the file: origin, offset and active count.
+static const Int64 VOLUMEFILE_INDEX_ENTRY_SIZE = 3 * sizeof(Int32) + sizeof(Int64) + sizeof(Int32);
+
+/// Number of tiles whose values are packed in memory before being written, 2 MB of values.
+static const Int VOLUMEFILE_WRITE_BATCH_TILES = 1024;
+
+/// Number of tiles packed by a worker with its own grid accessor.
+static const Int VOLUMEFILE_WRITE_CHUNK_TILES = 32;
+
+// File layout, native byte order:
+// Int32 magic, Int32 version, Int32 grid class, String grid name, 12 Float64 grid transform (off, v1, v2, v3),
+// Float32 background value, Int64 tile count,
+// then the tile index: Int32 origin x, y, z, Int64 file offset, Int32 active voxel count for each tile,
+// then the tiles: UInt64 mask[8], Float32 values[active voxel count] in the order of the mask bits.
+
+//----------------------------------------------------------------------------------------
+/// Returns the bit of a voxel in the mask of its tile.
+/// @param[in] coord							The coordinates of the voxel.
+/// @param[in] origin							The origin of the tile containing the voxel.
+/// @return												The bit index.
+//----------------------------------------------------------------------------------------
+static inline Int32 GetTileBit(const maxon::IntVector32& coord, const maxon::IntVector32& origin)
+{
+	return ((coord.x - origin.x) * VOLUMEFILE_TILE_DIM + (coord.y - origin.y)) * VOLUMEFILE_TILE_DIM + (coord.z - origin.z);
+}
+
+//----------------------------------------------------------------------------------------
+/// Checks if a bit of a tile mask is set.
+/// @param[in] mask								The mask of the tile.
+/// @param[in] bit								The bit index.
+/// @return												True if the voxel is active.
+//----------------------------------------------------------------------------------------
+static inline Bool IsTileBitSet(const UInt64* mask, Int32 bit)
+{
+	return (mask[bit >> 6] & (UInt64(1) << (bit & 63))) != 0;
+}
+
+//----------------------------------------------------------------------------------------
+/// Active voxels of a tile, gathered by WriteVolumeFile() before the values are read.
+//----------------------------------------------------------------------------------------
+struct VolumeFileTileMask
+{
+	maxon::IntVector32 _origin;													///< coordinates of the first voxel of the tile
+	UInt64						 _mask[VOLUMEFILE_TILE_VOXELS / 64];	///< active voxels, bit (x * 64 + y * 8 + z)
+	Int32							 _activeCount;										///< number of bits set in the mask
+};
+
+maxon::Result<void> WriteVolumeFile(const Filename& file, const maxon::VolumeRef& volume)
+{
+	iferr_scope;
+
+	R20FEATURES_PROFILE_SCOPE("WriteVolumeFile");
+
+	// first pass: gather the masks of the tiles containing active voxels; the values are read in batches of
+	// tiles while writing, so only the masks of the whole grid are held in memory
+	maxon::BaseArray<VolumeFileTileMask>	tiles;
+	maxon::HashMap<maxon::IntVector32, Int> tileLookup;
+	maxon::IntVector32										minCoord(maxon::LIMIT<Int32>::MAX);
+
+	maxon::GridIteratorRef<Float32, maxon::ITERATORTYPE::ON> iterator = maxon::GridIteratorRef<Float32, maxon::ITERATORTYPE::ON>::Create() iferr_return;
+	iterator.Init(volume) iferr_return;
+
+	for (; iterator.IsNotAtEnd(); iterator.StepNext())
+	{
+		const maxon::IntVector32 coord = iterator.GetCoords();
+		minCoord = maxon::IntVector32(maxon::Min(minCoord.x, coord.x), maxon::Min(minCoord.y, coord.y), maxon::Min(minCoord.z, coord.z));
+
+		// round down to a multiple of the tile size, also for negative coordinates
+		const maxon::IntVector32 origin(coord.x & ~(VOLUMEFILE_TILE_DIM - 1), coord.y & ~(VOLUMEFILE_TILE_DIM - 1), coord.z & ~(VOLUMEFILE_TILE_DIM - 1));
+
+		Bool created = false;
+		Int& tileIndex = tileLookup.InsertKey(origin, created) iferr_return;
+		if (created)
+		{
+			tileIndex = tiles.GetCount();
+
+			VolumeFileTileMask& newTile = tiles.Append() iferr_return;
+			newTile._origin = origin;
+			newTile._activeCount = 0;
+			for (UInt64& bits : newTile._mask)
+				bits = 0;
+		}
+
+		VolumeFileTileMask& tile = tiles[tileIndex];
+		const Int32					bit = GetTileBit(coord, origin);
+		tile._mask[bit >> 6] |= UInt64(1) << (bit & 63);
+		++tile._activeCount;
+	}
+
+	tileLookup.Reset();
+
+	const Int tileCount = tiles.GetCount();
+
+	maxon::GridAccessorRef<Float32> access = maxon::GridAccessorRef<Float32>::Create() iferr_return;
+	access.Init(volume, maxon::VOLUMESAMPLER::NEAREST) iferr_return;
+
+	// the value of the inactive voxels outside of the active ones, e.g. the exterior distance of a SDF
+	const Float32 background = tileCount > 0 ? access.GetValue(minCoord - maxon::IntVector32(1)) : 0.0f;
+
+	AutoAlloc<BaseFile> bf;
+	if (bf == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	if (!bf->Open(file, FILEOPEN::WRITE, FILEDIALOG::NONE))
+		return maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(file, MAXONCONVERTMODE::NONE), "Failed to open the volume file."_s);
+
+	// header
+	Bool written = bf->WriteInt32(VOLUMEFILE_MAGIC) && bf->WriteInt32(VOLUMEFILE_VERSION);
+	written = written && bf->WriteInt32(Int32(volume.GetGridClass())) && bf->WriteString(volume.GetGridName());
+
+	const maxon::Matrix transform = volume.GetGridTransform();
+	for (const maxon::Vector& v : { transform.off, transform.sqmat.v1, transform.sqmat.v2, transform.sqmat.v3 })
+		written = written && bf->WriteFloat64(v.x) && bf->WriteFloat64(v.y) && bf->WriteFloat64(v.z);
+
+	written = written && bf->WriteFloat32(background) && bf->WriteInt64(Int64(tileCount));
+
+	// tile index; the tiles follow it, so their offsets are known before writing them
+	Int64 offset = bf->GetPosition() + tileCount * VOLUMEFILE_INDEX_ENTRY_SIZE;
+	for (Int i = 0; written && i < tileCount; ++i)
+	{
+		const VolumeFileTileMask& tile = tiles[i];
+		written = bf->WriteInt32(tile._origin.x) && bf->WriteInt32(tile._origin.y) && bf->WriteInt32(tile._origin.z);
+		written = written && bf->WriteInt64(offset) && bf->WriteInt32(tile._activeCount);
+
+		offset += sizeof(VolumeFileTileMask::_mask) + tile._activeCount * sizeof(Float32);
+	}
+
+	// tiles, in batches: the values of the tiles of a batch are packed in parallel, each worker reading its
+	// chunk of tiles through its own accessor, then the batch is written sequentially
+	maxon::BaseArray<Float32> values;
+	values.Resize(maxon::Min(tileCount, VOLUMEFILE_WRITE_BATCH_TILES) * VOLUMEFILE_TILE_VOXELS) iferr_return;
+
+	for (Int batchStart = 0; written && batchStart < tileCount; batchStart += VOLUMEFILE_WRITE_BATCH_TILES)
+	{
+		const Int batchEnd = maxon::Min(batchStart + VOLUMEFILE_WRITE_BATCH_TILES, tileCount);
+		const Int chunkCount = (batchEnd - batchStart + VOLUMEFILE_WRITE_CHUNK_TILES - 1) / VOLUMEFILE_WRITE_CHUNK_TILES;
+
+		const maxon::Result<void> packRes = maxon::ParallelFor::Dynamic(0, chunkCount,
+			[&tiles, &values, &volume, batchStart, batchEnd](Int chunk) -> maxon::Result<void>
+			{
+				iferr_scope;
+
+				// an accessor caches the last visited node, it must not be shared between threads
+				maxon::GridAccessorRef<Float32> chunkAccess = maxon::GridAccessorRef<Float32>::Create() iferr_return;
+				chunkAccess.Init(volume, maxon::VOLUMESAMPLER::NEAREST) iferr_return;
+
+				const Int chunkStart = batchStart + chunk * VOLUMEFILE_WRITE_CHUNK_TILES;
+				const Int chunkEnd	 = maxon::Min(chunkStart + VOLUMEFILE_WRITE_CHUNK_TILES, batchEnd);
+				for (Int i = chunkStart; i < chunkEnd; ++i)
+				{
+					const VolumeFileTileMask& tile = tiles[i];
+					Float32* const						tileValues = values.GetFirst() + (i - batchStart) * VOLUMEFILE_TILE_VOXELS;
+
+					Int32 packed = 0;
+					for (Int32 bit = 0; bit < VOLUMEFILE_TILE_VOXELS; ++bit)
+					{
+						if (!IsTileBitSet(tile._mask, bit))
+							continue;
+
+						const maxon::IntVector32 coord(tile._origin.x + bit / (VOLUMEFILE_TILE_DIM * VOLUMEFILE_TILE_DIM),
+																					 tile._origin.y + (bit / VOLUMEFILE_TILE_DIM) % VOLUMEFILE_TILE_DIM,
+																					 tile._origin.z + bit % VOLUMEFILE_TILE_DIM);
+						tileValues[packed++] = chunkAccess.GetValue(coord);
+					}
+				}
+
+				return maxon::OK;
+			});
+
+		if (packRes == maxon::FAILED)
+			iferr_throw(packRes.GetError());
+
+		for (Int i = batchStart; written && i < batchEnd; ++i)
+		{
+			const VolumeFileTileMask& tile = tiles[i];
+			written = bf->WriteBytes(tile._mask, sizeof(tile._mask));
+			written = written && bf->WriteBytes(values.GetFirst() + (i - batchStart) * VOLUMEFILE_TILE_VOXELS, tile._activeCount * sizeof(Float32));
+		}
+	}
+
+	if (!written || !bf->Close())
+		return maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(file, MAXONCONVERTMODE::NONE), "Failed to write the volume file."_s);
+
+	return maxon::OK;
+}
+
+maxon::Result<void> VolumeFileReader::Open(const Filename& file)
+{
+	iferr_scope;
+
+	if (_file == nullptr)
+		return maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION);
+
+	_index.Reset();
+	if (!_file->Open(file, FILEOPEN::READ, FILEDIALOG::NONE))
+		return maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(file, MAXONCONVERTMODE::NONE), "Failed to open the volume file."_s);
+
+	const maxon::Error readError = maxon::IoError(MAXON_SOURCE_LOCATION, MaxonConvert(file, MAXONCONVERTMODE::NONE), "Invalid volume file."_s);
+
+	// header
+	Int32 magic = 0, version = 0, gridClass = 0;
+	if (!_file->ReadInt32(&magic) || !_file->ReadInt32(&version) || magic != VOLUMEFILE_MAGIC || version != VOLUMEFILE_VERSION)
+		return readError;
+
+	if (!_file->ReadInt32(&gridClass) || !_file->ReadString(&_gridName))
+		return readError;
+	_gridClass = GRIDCLASS(gridClass);
+
+	for (maxon::Vector* v : { &_transform.off, &_transform.sqmat.v1, &_transform.sqmat.v2, &_transform.sqmat.v3 })
+	{
+		if (!_file->ReadFloat64(&v->x) || !_file->ReadFloat64(&v->y) || !_file->ReadFloat64(&v->z))
+			return readError;
+	}
+
+	Int64 tileCount = 0;
+	if (!_file->ReadFloat32(&_background) || !_file->ReadInt64(&tileCount) || tileCount < 0)
+		return readError;
+
+	// tile index
+	_index.Resize(Int(tileCount)) iferr_return;
+	for (IndexEntry& entry : _index)
+	{
+		if (!_file->ReadInt32(&entry._origin.x) || !_file->ReadInt32(&entry._origin.y) || !_file->ReadInt32(&entry._origin.z))
+			return readError;
+		if (!_file->ReadInt64(&entry._offset) || !_file->ReadInt32(&entry._activeCount))
+			return readError;
+		if (entry._activeCount < 0 || entry._activeCount > VOLUMEFILE_TILE_VOXELS)
+			return readError;
+	}
+
+	return maxon::OK;
+}
+
+maxon::Result<void> VolumeFileReader::LoadTile(Int index, VolumeFileTile& tile)
+{
+	const IndexEntry& entry = _index[index];
+	const Int					valuesSize = entry._activeCount * sizeof(Float32);
+
+	tile._origin = entry._origin;
+
+	if (!_file->Seek(entry._offset, FILESEEK::START)
+			|| _file->ReadBytes(tile._mask, sizeof(tile._mask), true) != Int(sizeof(tile._mask))
+			|| _file->ReadBytes(tile._values, valuesSize, true) != valuesSize)
+		return maxon::IoError(MAXON_SOURCE_LOCATION, maxon::Url(), "Failed to read a volume file tile."_s);
+
+	// unpack from the end, so the packed values are not overwritten before they are moved
+	Int32 packed = entry._activeCount;
+	for (Int32 bit = VOLUMEFILE_TILE_VOXELS - 1; bit >= 0; --bit)
+	{
+		if (IsTileBitSet(tile._mask, bit) && packed > 0)
+			tile._values[bit] = tile._values[--packed];
+		else
+			tile._values[bit] = _background;
+	}
+
+	return maxon::OK;
+}
+
+maxon::Result<maxon::VolumeRef> VolumeFileReader::CreateVolume()
+{
+	iferr_scope;
+
+	R20FEATURES_PROFILE_SCOPE("VolumeFileReader::CreateVolume");
+
+	maxon::VolumeRef volume = maxon::VolumeToolsInterface::CreateNewFloat32Volume(_background) iferr_return;
+	volume.SetGridClass(_gridClass);
+	volume.SetGridName(_gridName);
+	volume.SetGridTransform(_transform);
+
+	maxon::GridAccessorRef<Float32> access = maxon::GridAccessorRef<Float32>::Create() iferr_return;
+	access.Init(volume, maxon::VOLUMESAMPLER::NEAREST) iferr_return;
+
+	VolumeFileTile tile;
+	for (Int i = 0; i < GetTileCount(); ++i)
+	{
+		LoadTile(i, tile) iferr_return;
+
+		for (Int32 bit = 0; bit < VOLUMEFILE_TILE_VOXELS; ++bit)
+		{
+			if (!IsTileBitSet(tile._mask, bit))
+				continue;
+
+			const maxon::IntVector32 coord(tile._origin.x + bit / (VOLUMEFILE_TILE_DIM * VOLUMEFILE_TILE_DIM),
+																		 tile._origin.y + (bit / VOLUMEFILE_TILE_DIM) % VOLUMEFILE_TILE_DIM,
+																		 tile._origin.z + bit % VOLUMEFILE_TILE_DIM);
+			access.SetValue(coord, tile._values[bit]) iferr_return;
+		}
+	}
+
+	return volume;
+}
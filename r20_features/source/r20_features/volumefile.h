@@ -0,0 +1,102 @@
+#ifndef DEVKITCHEN18_R20_VOLUMEFILE_H__
+#define DEVKITCHEN18_R20_VOLUMEFILE_H__
+
+// classic API header files
+#include "c4d_file.h"
+
+// MAXON API header files
+#include "maxon/basearray.h"
+#include "maxon/volume.h"
+
+/// Edge length of a volume file tile in voxels.
+static const Int32 VOLUMEFILE_TILE_DIM = 8;
+
+/// Number of voxels of a volume file tile.
+static const Int32 VOLUMEFILE_TILE_VOXELS = VOLUMEFILE_TILE_DIM * VOLUMEFILE_TILE_DIM * VOLUMEFILE_TILE_DIM;
+
+//----------------------------------------------------------------------------------------
+/// A tile of 8x8x8 voxels of a volume file. Only the voxels whose bit is set in the mask are active.
+//----------------------------------------------------------------------------------------
+struct VolumeFileTile
+{
+	maxon::IntVector32 _origin;													///< coordinates of the first voxel of the tile
+	UInt64						 _mask[VOLUMEFILE_TILE_VOXELS / 64];	///< active voxels, bit (x * 64 + y * 8 + z)
+	Float32						 _values[VOLUMEFILE_TILE_VOXELS];			///< values of the voxels, indexed as the mask bits
+};
+
+//----------------------------------------------------------------------------------------
+/// Writes the active voxels of a Float32 volume into a tile-sparse binary file together
+/// with its transform, grid class, name and background value. The values are packed in parallel and
+/// written in batches of tiles, only the masks of the active voxels of the whole grid are held in memory. The background value
+/// is the value of the inactive voxels outside of the active ones; inactive voxels with other values,
+/// like the interior tiles of a narrow-band level set, are read back with the background value.
+/// @param[in] file								The file to write.
+/// @param[in] volume							The volume to store.
+/// @return												maxon::OK on success.
+//----------------------------------------------------------------------------------------
+maxon::Result<void> WriteVolumeFile(const Filename& file, const maxon::VolumeRef& volume);
+
+//----------------------------------------------------------------------------------------
+/// Reads a volume file written by WriteVolumeFile(). Opening reads only the header and the
+/// tile index, tiles are loaded on demand.
+//----------------------------------------------------------------------------------------
+class VolumeFileReader
+{
+public:
+	//----------------------------------------------------------------------------------------
+	/// Opens a volume file and reads its header and tile index.
+	/// @param[in] file								The file to read.
+	/// @return												maxon::OK on success.
+	//----------------------------------------------------------------------------------------
+	maxon::Result<void> Open(const Filename& file);
+
+	//----------------------------------------------------------------------------------------
+	/// Returns the number of tiles with active voxels.
+	/// @return												The number of tiles.
+	//----------------------------------------------------------------------------------------
+	Int GetTileCount() const { return _index.GetCount(); }
+
+	//----------------------------------------------------------------------------------------
+	/// Returns the origin of a tile without loading it.
+	/// @param[in] index							The tile index.
+	/// @return												The coordinates of the first voxel of the tile.
+	//----------------------------------------------------------------------------------------
+	const maxon::IntVector32& GetTileOrigin(Int index) const { return _index[index]._origin; }
+
+	//----------------------------------------------------------------------------------------
+	/// Loads a tile from the file.
+	/// @param[in] index							The tile index.
+	/// @param[out] tile							The loaded tile, inactive voxels have the background value.
+	/// @return												maxon::OK on success.
+	//----------------------------------------------------------------------------------------
+	maxon::Result<void> LoadTile(Int index, VolumeFileTile& tile);
+
+	//----------------------------------------------------------------------------------------
+	/// Creates a volume with the stored settings and background value and loads all the tiles into it.
+	/// @return												The created volume.
+	//----------------------------------------------------------------------------------------
+	maxon::Result<maxon::VolumeRef> CreateVolume();
+
+	const String& GetGridName() const { return _gridName; }
+	GRIDCLASS GetGridClass() const { return _gridClass; }
+	const maxon::Matrix& GetGridTransform() const { return _transform; }
+	Float32 GetBackground() const { return _background; }
+
+private:
+	/// Position of a tile in the file.
+	struct IndexEntry
+	{
+		maxon::IntVector32 _origin;
+		Int64							 _offset;
+		Int32							 _activeCount;
+	};
+
+	AutoAlloc<BaseFile>						_file;
+	maxon::BaseArray<IndexEntry>	_index;
+	String												_gridName;
+	GRIDCLASS											_gridClass = GRIDCLASS::NONE;
+	maxon::Matrix									_transform;
+	Float32												_background = 0.0f;
+};
+
+#endif // DEVKITCHEN18_R20_VOLUMEFILE_H__
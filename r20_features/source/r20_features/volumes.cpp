@@ -1,6 +1,10 @@
 // local header files and resources
 #include "r20_features.h"
 #include "c4d_symbols.h"
+#include "profiling.h"
+#include "objectbatch.h"
+#include "volumefile.h"
+#include "fieldvolumeaccess.h"
 
 // classic API header files
 #include "c4d_general.h"
@@ -18,7 +22,6 @@
 
 // MAXON API header files
 #include "maxon/volume.h"
-#include "maxon/volumeiterators.h"
 #include "maxon/volumetools.h"
 #include "maxon/volumeaccessors.h"
 #include "maxon/volumecommands.h"
@@ -182,69 +185,51 @@ Bool ReadVolumeCommand::Execute(BaseDocument* doc)
 	VolumeObject* const		 volumeObject = static_cast<VolumeObject*>(cache);
 	const maxon::VolumeRef volume = volumeObject->GetVolume();
 
-	// create iterator
-	maxon::GridIteratorRef<maxon::Float32, maxon::ITERATORTYPE::ON> iterator = maxon::GridIteratorRef<maxon::Float32, maxon::ITERATORTYPE::ON>::Create() iferr_return;
-	iterator.Init(volume) iferr_return;
-
 	// get radius (based on the voxel size)
 	GeData data;
 	object->GetParameter(DescID(ID_VOLUMEBUILDER_GRID_SIZE), data, DESCFLAGS_GET::NONE);
 	const Float radius = data.GetFloat() * .5;
 
-	// start undo-step
-	doc->StartUndo();
+	// collect the world space position and the value of every cell with content
+	// the iteration is sequential, the objects are then created in parallel
+	maxon::BaseArray<Vector>	positions;
+	maxon::BaseArray<Float32> values;
 
-	maxon::AggregatedError aggError;
+	MAXON_SCOPE
+	{
+		R20FEATURES_PROFILE_SCOPE("ReadVolumeCommand: iterate volume");
 
-	// get transformation matrix
-	const maxon::Matrix transform = volume.GetGridTransform();
+		ForEachActiveVoxel(volume,
+			[&positions, &values](const Vector& pos, Float32 value) -> maxon::Result<void>
+			{
+				iferr_scope;
 
-	// check every cell with content
-	for (; iterator.IsNotAtEnd(); iterator.StepNext())
-	{
-		// create a null objects
-		BaseObject* const null = BaseObject::Alloc(Onull);
-		if (null == nullptr)
-		{
-			aggError.AddError(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't break the loop.");
-			continue;
-		}
+				R20FEATURES_PROFILE_COUNT("ReadVolumeCommand: active voxels", 1);
 
-		// insert the null into the document
-		doc->InsertObject(null, nullptr, nullptr);
-		doc->AddUndo(UNDOTYPE::NEWOBJ, null);
-
-		// get coordinates
-		const maxon::IntVector32 coord = iterator.GetCoords();
-
-		// get world space coordinates
-		Vector pos;
-		pos.x = coord.x;
-		pos.y = coord.y;
-		pos.z = coord.z;
-		pos = transform * pos;
-		null->SetRelPos(pos);
-
-		// set display options
-		null->SetParameter(DescID(NULLOBJECT_DISPLAY), NULLOBJECT_DISPLAY_CUBE, DESCFLAGS_SET::NONE);
-		null->SetParameter(DescID(NULLOBJECT_RADIUS), radius, DESCFLAGS_SET::NONE);
-		null->SetParameter(DescID(NULLOBJECT_ORIENTATION), NULLOBJECT_ORIENTATION_ZY, DESCFLAGS_SET::NONE);
-
-		// get value and store it as the object's name
-		const Float32 value = iterator.GetValue();
-		const String	valueStr = FormatString("@", value);
-		null->SetName(valueStr);
+				positions.Append(pos) iferr_return;
+				values.Append(value) iferr_return;
+
+				return maxon::OK;
+			}) iferr_return;
 	}
 
-	doc->EndUndo();
+	// create a null object for each cell, all inserted at once with a single undo-step
+	InsertObjectBatch(*doc, GeLoadString(IDS_READ_VOLUME_COMMAND), Onull, positions.GetCount(),
+		[&positions, &values, radius](Int i, BaseObject& null)
+		{
+			null.SetRelPos(positions[i]);
 
-	EventAdd();
+			// set display options
+			null.SetParameter(DescID(NULLOBJECT_DISPLAY), NULLOBJECT_DISPLAY_CUBE, DESCFLAGS_SET::NONE);
+			null.SetParameter(DescID(NULLOBJECT_RADIUS), radius, DESCFLAGS_SET::NONE);
+			null.SetParameter(DescID(NULLOBJECT_ORIENTATION), NULLOBJECT_ORIENTATION_ZY, DESCFLAGS_SET::NONE);
 
-	// check if any errors occurred
-	if (aggError.GetCount() > 0)
-	{
-		iferr_throw(aggError);
-	}
+			// store the value as the object's name
+			const String valueStr = FormatString("@", values[i]);
+			null.SetName(valueStr);
+		}) iferr_return;
+
+	EventAdd();
 
 	return true;
 }
@@ -328,34 +313,40 @@ Bool CreateVolumeCommand::Execute(BaseDocument* doc)
 	const Float noiseScale = 25.0;
 
 	// for each cell of the volume define a value
-	for (Int32 x = 0; x < dimension; ++x)
+	MAXON_SCOPE
 	{
-		for (Int32 y = 0; y < dimension; ++y)
+		R20FEATURES_PROFILE_SCOPE("CreateVolumeCommand: fill volume");
+		R20FEATURES_PROFILE_COUNT("CreateVolumeCommand: written voxels", dimension * dimension * dimension);
+
+		for (Int32 x = 0; x < dimension; ++x)
 		{
-			for (Int32 z = 0; z < dimension; ++z)
+			for (Int32 y = 0; y < dimension; ++y)
 			{
-				// create coordinates in the range of -halfDimension / +halfDimension
-				Vector pos;
-				pos.x = Float(x - halfDimension);
-				pos.y = Float(y - halfDimension);
-				pos.z = Float(z - halfDimension);
-
-				// create coordinates in the range of -1 / +1
-				const Vector scaledPos = pos / Float(halfDimension);
-
-				// sample noise
-				const Float	 noiseFactor = noise->Noise(NoiseType::NOISE_NOISE, false, scaledPos);
-				// map noise values into the range of -v / +v.
-				const Float	 value = (noiseFactor - 0.5) * noiseScale;
-
-				// create int coordinates
-				maxon::IntVector32 coords;
-				coords.x = x;
-				coords.z = z;
-				coords.y = y;
-
-				// set value
-				access.SetValue(coords, Float32(value)) iferr_return;
+				for (Int32 z = 0; z < dimension; ++z)
+				{
+					// create coordinates in the range of -halfDimension / +halfDimension
+					Vector pos;
+					pos.x = Float(x - halfDimension);
+					pos.y = Float(y - halfDimension);
+					pos.z = Float(z - halfDimension);
+
+					// create coordinates in the range of -1 / +1
+					const Vector scaledPos = pos / Float(halfDimension);
+
+					// sample noise
+					const Float	 noiseFactor = noise->Noise(NoiseType::NOISE_NOISE, false, scaledPos);
+					// map noise values into the range of -v / +v.
+					const Float	 value = (noiseFactor - 0.5) * noiseScale;
+
+					// create int coordinates
+					maxon::IntVector32 coords;
+					coords.x = x;
+					coords.z = z;
+					coords.y = y;
+
+					// set value
+					access.SetValue(coords, Float32(value)) iferr_return;
+				}
 			}
 		}
 	}
@@ -461,7 +452,12 @@ Bool CombineObjectsCommand::Execute(BaseDocument* doc)
 		const auto command = maxon::CommandClasses::MESHTOVOLUME();
 
 		// execute command on the given context
-		const maxon::COMMANDRESULT res = context.Invoke(command, false) iferr_return;
+		maxon::COMMANDRESULT res;
+		MAXON_SCOPE
+		{
+			R20FEATURES_PROFILE_SCOPE("CombineObjectsCommand: MESHTOVOLUME");
+			res = context.Invoke(command, false) iferr_return;
+		}
 
 		// check command success
 		if (res != maxon::COMMANDRESULT::OK)
@@ -500,7 +496,12 @@ Bool CombineObjectsCommand::Execute(BaseDocument* doc)
 		const auto command = maxon::CommandClasses::BOOLE();
 
 		// execute command on the given context
-		const maxon::COMMANDRESULT res = context.Invoke(command, false) iferr_return;
+		maxon::COMMANDRESULT res;
+		MAXON_SCOPE
+		{
+			R20FEATURES_PROFILE_SCOPE("CombineObjectsCommand: BOOLE");
+			res = context.Invoke(command, false) iferr_return;
+		}
 
 		// check command success
 		if (res != maxon::COMMANDRESULT::OK)
@@ -535,7 +536,12 @@ Bool CombineObjectsCommand::Execute(BaseDocument* doc)
 		const auto command = maxon::CommandClasses::VOLUMETOMESH();
 
 		// execute command on the given context
-		const maxon::COMMANDRESULT res = context.Invoke(command, false) iferr_return;
+		maxon::COMMANDRESULT res;
+		MAXON_SCOPE
+		{
+			R20FEATURES_PROFILE_SCOPE("CombineObjectsCommand: VOLUMETOMESH");
+			res = context.Invoke(command, false) iferr_return;
+		}
 
 		// check command success
 		if (res != maxon::COMMANDRESULT::OK)
@@ -585,6 +591,127 @@ CombineObjectsCommand* CombineObjectsCommand::Alloc()
 	return NewObjClear(CombineObjectsCommand);
 }
 
+//----------------------------------------------------------------------------------------
+/// An example command exporting the volume of the selected volume object or volume builder
+/// into a tile-sparse binary file. Only the active voxels and the background value are stored:
+/// the inactive interior voxels of a SDF are imported back with the positive background value,
+/// so a SDF whose interior is not active is imported as a narrow band shell.
+//----------------------------------------------------------------------------------------
+class ExportVolumeCommand : public CommandData
+{
+	INSTANCEOF(ExportVolumeCommand, CommandData)
+
+public:
+	Bool Execute(BaseDocument* doc);
+	static ExportVolumeCommand* Alloc();
+};
+
+Bool ExportVolumeCommand::Execute(BaseDocument* doc)
+{
+	iferr_scope_handler
+	{
+		// if an error occurred, print the error to the IDE console and trigger a debug stop
+		err.DiagOutput();
+		err.DbgStop();
+		return false;
+	};
+
+	// access the selected object
+	BaseObject* const object = doc->GetActiveObject();
+	if (object == nullptr)
+		return true;
+
+	// a volume builder stores its volume object in its cache
+	BaseObject* const volumeSource = object->IsInstanceOf(Ovolumebuilder) ? object->GetCache() : object;
+	if (volumeSource == nullptr || volumeSource->IsInstanceOf(Ovolume) == false)
+		iferr_throw(maxon::IllegalArgumentError(MAXON_SOURCE_LOCATION));
+
+	const maxon::VolumeRef volume = static_cast<VolumeObject*>(volumeSource)->GetVolume();
+
+	// select the target file
+	Filename file;
+	if (!file.FileSelect(FILESELECTTYPE::ANYTHING, FILESELECT::SAVE, GeLoadString(IDS_EXPORT_VOLUME_COMMAND)))
+		return true;
+
+	WriteVolumeFile(file, volume) iferr_return;
+
+	return true;
+}
+
+ExportVolumeCommand* ExportVolumeCommand::Alloc()
+{
+	return NewObjClear(ExportVolumeCommand);
+}
+
+//----------------------------------------------------------------------------------------
+/// An example command importing a volume file written by ExportVolumeCommand into a new volume object.
+/// The inactive voxels get the stored background value, see ExportVolumeCommand for the SDF limitation.
+//----------------------------------------------------------------------------------------
+class ImportVolumeCommand : public CommandData
+{
+	INSTANCEOF(ImportVolumeCommand, CommandData)
+
+public:
+	Bool Execute(BaseDocument* doc);
+	static ImportVolumeCommand* Alloc();
+};
+
+Bool ImportVolumeCommand::Execute(BaseDocument* doc)
+{
+	iferr_scope_handler
+	{
+		// if an error occurred, print the error to the IDE console and trigger a debug stop
+		err.DiagOutput();
+		err.DbgStop();
+		return false;
+	};
+
+	// select the source file
+	Filename file;
+	if (!file.FileSelect(FILESELECTTYPE::ANYTHING, FILESELECT::LOAD, GeLoadString(IDS_IMPORT_VOLUME_COMMAND)))
+		return true;
+
+	// read the volume before changing the document
+	VolumeFileReader reader;
+	reader.Open(file) iferr_return;
+	const maxon::VolumeRef volume = reader.CreateVolume() iferr_return;
+
+	// create volume object and volume mesher
+	VolumeObject* volumeObj = VolumeObject::Alloc();
+	BaseObject*		mesher = BaseObject::Alloc(1039861);
+
+	// check for successful allocation
+	if (volumeObj == nullptr || mesher == nullptr)
+	{
+		VolumeObject::Free(volumeObj);
+		BaseObject::Free(mesher);
+		iferr_throw(maxon::OutOfMemoryError(MAXON_SOURCE_LOCATION));
+	}
+
+	volumeObj->SetName(reader.GetGridName());
+	volumeObj->SetVolume(volume);
+
+	// add a phong tag to the mesher
+	mesher->SetPhong(true, true, DegToRad(60.0));
+
+	// insert the mesher and the volume object into the scene
+	doc->StartUndo();
+	doc->InsertObject(mesher, nullptr, nullptr);
+	doc->AddUndo(UNDOTYPE::NEWOBJ, mesher);
+	doc->InsertObject(volumeObj, mesher, nullptr);
+	doc->AddUndo(UNDOTYPE::NEWOBJ, volumeObj);
+	doc->EndUndo();
+
+	EventAdd();
+
+	return true;
+}
+
+ImportVolumeCommand* ImportVolumeCommand::Alloc()
+{
+	return NewObjClear(ImportVolumeCommand);
+}
+
 void RegisterVolumeExamples()
 {
 	// prepare aggregated error to collect errors while registering the plugins
@@ -611,6 +738,16 @@ void RegisterVolumeExamples()
 		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
 
 
+	const Bool exportCommandRes = RegisterCommandPlugin(1050291, GeLoadString(IDS_EXPORT_VOLUME_COMMAND), 0, nullptr, ""_s, ExportVolumeCommand::Alloc());
+	if (exportCommandRes == false)
+		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
+
+
+	const Bool importCommandRes = RegisterCommandPlugin(1050292, GeLoadString(IDS_IMPORT_VOLUME_COMMAND), 0, nullptr, ""_s, ImportVolumeCommand::Alloc());
+	if (importCommandRes == false)
+		aggErr.AddError(maxon::UnexpectedError(MAXON_SOURCE_LOCATION)) iferr_ignore("Don't skip registration.");
+
+
 	// check if any error occurred
 	if (aggErr.GetCount() != 0)
 	{